@@ -131,15 +131,21 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/common/fvbaseproperties.hh
              opm/models/discretization/common/fvbaseextensivequantities.hh
              opm/models/discretization/common/fvbaselinearizer.hh
+             opm/models/discretization/common/facebatchevaluation.hh
+             opm/models/discretization/common/stencilcache.hh
              opm/models/discretization/common/tpfalinearizer.hh
              opm/models/discretization/common/restrictprolong.hh
              opm/models/discretization/common/fvbasediscretization.hh
              opm/models/discretization/common/fvbasediscretizationfemadapt.hh
              opm/models/discretization/common/fvbasegradientcalculator.hh
              opm/models/discretization/common/fvbaseproblem.hh
+             opm/models/discretization/common/fvbasetimestepcontroller.hh
+             opm/models/discretization/common/pidtimestepcontroller.hh
              opm/models/discretization/common/fvbaseprimaryvariables.hh
              opm/models/discretization/common/linearizationtype.hh
+             opm/models/discretization/common/reorderedmapper.hh
              opm/models/discretization/ecfv/ecfvgridcommhandlefactory.hh
+             opm/models/discretization/ecfv/ecfvcompactstencil.hh
              opm/models/discretization/ecfv/ecfvstencil.hh
              opm/models/discretization/ecfv/ecfvbaseoutputmodule.hh
              opm/models/discretization/ecfv/ecfvdiscretization.hh
@@ -202,12 +208,15 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/nonlinear/nullconvergencewriter.hh
              opm/models/nonlinear/newtonmethod.hh
              opm/models/nonlinear/newtonmethodproperties.hh
+             opm/models/nonlinear/nlddsolver.hh
              opm/models/parallel/mpiutil.hh
              opm/models/parallel/tasklets.hh
              opm/models/parallel/threadmanager.hh
              opm/models/parallel/gridcommhandles.hh
              opm/models/parallel/mpibuffer.hh
              opm/models/parallel/threadedentityiterator.hh
+             opm/models/parallel/elementchunks.hh
+             opm/models/parallel/costbalancedloopscheduler.hh
              opm/models/pvs/pvsboundaryratevector.hh
              opm/models/pvs/pvsratevector.hh
              opm/models/pvs/pvsindices.hh
@@ -249,6 +258,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/linalgproperties.hh
              opm/simulators/linalg/linearsolverreport.hh
              opm/simulators/linalg/istlsparsematrixadapter.hh
+             opm/simulators/linalg/csrsparsitypattern.hh
              opm/simulators/linalg/istlpreconditionerwrappers.hh
              opm/simulators/linalg/residreductioncriterion.hh
              opm/simulators/linalg/overlappingbcrsmatrix.hh
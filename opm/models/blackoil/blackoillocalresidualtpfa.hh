@@ -38,10 +38,16 @@
 #include "blackoildiffusionmodule.hh"
 #include "blackoildispersionmodule.hh"
 #include "blackoilmicpmodules.hh"
+#include <opm/models/discretization/common/facebatchevaluation.hh>
+#include <opm/material/densead/Evaluation.hpp>
 #include <opm/material/fluidstates/BlackOilFluidState.hpp>
 #include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
 #include <opm/input/eclipse/Schedule/BCProp.hpp>
 
+#include <array>
+#include <cassert>
+#include <type_traits>
+
 namespace Opm {
 /*!
  * \ingroup BlackOilModel
@@ -110,20 +116,75 @@ class BlackOilLocalResidualTPFA : public GetPropType<TypeTag, Properties::DiscLo
 
 public:
 
+    // The coefficients of a face which are only required by some of the modules. They
+    // are only stored by ResidualNBInfo if the respective module is enabled.
+    struct EnergyNBInfo
+    {
+        double inAlpha;
+        double outAlpha;
+    };
+    struct NoEnergyNBInfo {};
+
+    struct DiffusionNBInfo
+    {
+        double diffusivity;
+    };
+    struct NoDiffusionNBInfo {};
+
+    struct DispersionNBInfo
+    {
+        double dispersivity;
+    };
+    struct NoDispersionNBInfo {};
+
     struct ResidualNBInfo
+        : public std::conditional_t<enableEnergy, EnergyNBInfo, NoEnergyNBInfo>
+        , public std::conditional_t<enableDiffusion, DiffusionNBInfo, NoDiffusionNBInfo>
+        , public std::conditional_t<enableDispersion, DispersionNBInfo, NoDispersionNBInfo>
     {
         double trans;
         double faceArea;
         double thpres;
         double dZg;
-        FaceDir::DirEnum faceDirection;
         double Vin;
         double Vex;
-        double inAlpha;
-        double outAlpha;
-        double diffusivity;
-        double dispersivity;
+        FaceDir::DirEnum faceDirection;
+    };
+
+    /*!
+     * \brief Evaluation type used by the face based flux kernel.
+     *
+     * The first numEq derivatives are taken with regard to the primary variables of
+     * the interior cell of a face, the remaining ones with regard to the primary
+     * variables of the exterior cell.
+     */
+    using FaceEvaluation = DenseAd::Evaluation<Scalar, 2*numEq>;
+    using FaceRateVector = Dune::FieldVector<FaceEvaluation, numEq>;
+
+    /*!
+     * \brief The input of a face of the batched flux kernel.
+     *
+     * The members correspond to the arguments of computeFaceFlux().
+     */
+    struct FaceBatchLane
+    {
+        unsigned globalIndexIn;
+        unsigned globalIndexEx;
+        const IntensiveQuantities* intQuantsIn;
+        const IntensiveQuantities* intQuantsEx;
+        const ResidualNBInfo* nbInfoIn;
+        const ResidualNBInfo* nbInfoEx;
     };
+
+    //! Rate vector without derivatives as used by the value-only flux kernel
+    using ScalarRateVector = Dune::FieldVector<Scalar, numEq>;
+
+    //! Specifies whether computeFaceFlux() can be used for the enabled modules
+    static constexpr bool enableFaceFluxKernel = !enableEnergy && !enableDiffusion && !enableDispersion;
+
+    //! Specifies whether computeFlux() can be called with a ScalarRateVector for the
+    //! enabled modules
+    static constexpr bool enableScalarFluxKernel = !enableEnergy && !enableDiffusion && !enableDispersion;
     /*!
      * \copydoc FvBaseLocalResidual::computeStorage
      */
@@ -242,6 +303,76 @@ public:
                          nbInfo);
     }
 
+    /*!
+     * \brief Compute the flux between two cells without any derivatives.
+     *
+     * This is used to evaluate the residual without the Jacobian. The upwind decision
+     * and the pressure difference are the same as for the other variants of
+     * computeFlux().
+     */
+    static void computeFlux(ScalarRateVector& flux,
+                            ScalarRateVector& darcy,
+                            const unsigned globalIndexIn,
+                            const unsigned globalIndexEx,
+                            const IntensiveQuantities& intQuantsIn,
+                            const IntensiveQuantities& intQuantsEx,
+                            const ResidualNBInfo& nbInfo)
+    {
+        OPM_TIMEBLOCK_LOCAL(computeFluxValues);
+        static_assert(enableScalarFluxKernel,
+                      "The value-only flux is not implemented for the enabled modules");
+        flux = 0.0;
+        darcy = 0.0;
+
+        const Scalar trans = nbInfo.trans;
+        const Scalar faceArea = nbInfo.faceArea;
+        const FaceDir::DirEnum facedir = nbInfo.faceDirection;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            short dnIdx;
+            short upIdx;
+            short interiorDofIdx = 0;
+            short exteriorDofIdx = 1;
+            // the pressure difference is computed by the extensive quantities which
+            // only work on Evaluations. it is cheap compared to the rest, though.
+            Evaluation pressureDifference;
+            ExtensiveQuantities::calculatePhasePressureDiff_(upIdx,
+                                                             dnIdx,
+                                                             pressureDifference,
+                                                             intQuantsIn,
+                                                             intQuantsEx,
+                                                             phaseIdx,
+                                                             interiorDofIdx,
+                                                             exteriorDofIdx,
+                                                             nbInfo.Vin,
+                                                             nbInfo.Vex,
+                                                             globalIndexIn,
+                                                             globalIndexEx,
+                                                             nbInfo.dZg,
+                                                             nbInfo.thpres);
+
+            const IntensiveQuantities& up = (upIdx == interiorDofIdx) ? intQuantsIn : intQuantsEx;
+            const Scalar pressureDiff = Toolbox::value(pressureDifference);
+            Scalar darcyFlux = 0.0;
+            if (pressureDiff != 0.0) {
+                darcyFlux = pressureDiff
+                    * Toolbox::value(up.mobility(phaseIdx, facedir))
+                    * Toolbox::value(up.rockCompTransMultiplier())
+                    * (-trans / faceArea);
+            }
+            unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
+            darcy[conti0EqIdx + activeCompIdx] = darcyFlux * faceArea;
+
+            unsigned pvtRegionIdx = up.pvtRegionIndex();
+            const Scalar invB = getInvB_<FluidSystem, FluidState, Scalar>(up.fluidState(), phaseIdx, pvtRegionIdx);
+            const Scalar surfaceVolumeFlux = invB * darcyFlux;
+            evalPhaseFluxes_<Scalar, Scalar, FluidState>(
+                flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, up.fluidState());
+        }
+    }
+
     // This function demonstrates compatibility with the ElementContext-based interface.
     // Actually using it will lead to double work since the element context already contains
     // fluxes through its stored ExtensiveQuantities.
@@ -297,12 +428,22 @@ public:
         // exterior DOF)
         const Scalar distZ = zIn - zEx;
         // for thermal harmonic mean of half trans
-        const Scalar inAlpha = problem.thermalHalfTransmissibility(globalIndexIn, globalIndexEx);
-        const Scalar outAlpha = problem.thermalHalfTransmissibility(globalIndexEx, globalIndexIn);
-        const Scalar diffusivity = problem.diffusivity(globalIndexEx, globalIndexIn);
-        const Scalar dispersivity = problem.dispersivity(globalIndexEx, globalIndexIn);
-
-        const ResidualNBInfo res_nbinfo {trans, faceArea, thpres, distZ * g, facedir, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity};
+        ResidualNBInfo res_nbinfo{};
+        res_nbinfo.trans = trans;
+        res_nbinfo.faceArea = faceArea;
+        res_nbinfo.thpres = thpres;
+        res_nbinfo.dZg = distZ * g;
+        res_nbinfo.faceDirection = facedir;
+        res_nbinfo.Vin = Vin;
+        res_nbinfo.Vex = Vex;
+        if constexpr (enableEnergy) {
+            res_nbinfo.inAlpha = problem.thermalHalfTransmissibility(globalIndexIn, globalIndexEx);
+            res_nbinfo.outAlpha = problem.thermalHalfTransmissibility(globalIndexEx, globalIndexIn);
+        }
+        if constexpr (enableDiffusion)
+            res_nbinfo.diffusivity = problem.diffusivity(globalIndexEx, globalIndexIn);
+        if constexpr (enableDispersion)
+            res_nbinfo.dispersivity = problem.dispersivity(globalIndexEx, globalIndexIn);
 
         calculateFluxes_(flux,
                          darcy,
@@ -478,6 +619,257 @@ public:
 
     }
 
+    /*!
+     * \brief Compute the flux over an interior face in one go.
+     *
+     * In contrast to computeFlux(), the result contains the derivatives with regard
+     * to the primary variables of both cells adjacent to the face, so the face only
+     * needs to be visited once. The upwind decision is made exactly as it is for the
+     * cell based kernel: the pressure differences are determined from both sides,
+     * which makes sure that the result is identical to two calls of computeFlux().
+     *
+     * \param flux The flux from the interior to the exterior cell
+     * \param darcy The volumetric fluxes of the phases (values only)
+     * \param nbInfoIn The neighbor information as seen from the interior cell
+     * \param nbInfoEx The neighbor information as seen from the exterior cell
+     */
+    static void computeFaceFlux(FaceRateVector& flux,
+                                RateVector& darcy,
+                                const unsigned globalIndexIn,
+                                const unsigned globalIndexEx,
+                                const IntensiveQuantities& intQuantsIn,
+                                const IntensiveQuantities& intQuantsEx,
+                                const ResidualNBInfo& nbInfoIn,
+                                const ResidualNBInfo& nbInfoEx)
+    {
+        OPM_TIMEBLOCK_LOCAL(computeFaceFlux);
+        static_assert(enableFaceFluxKernel,
+                      "The face based flux kernel does not support the enabled modules.");
+
+        flux = 0.0;
+        darcy = 0.0;
+
+        const Scalar trans = nbInfoIn.trans;
+        const Scalar faceArea = nbInfoIn.faceArea;
+        const FaceDir::DirEnum facedir = nbInfoIn.faceDirection;
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            short interiorDofIdx = 0; // NB
+            short exteriorDofIdx = 1; // NB
+            short upIdx;
+            short dnIdx;
+            Evaluation pressureDifferenceIn;
+            ExtensiveQuantities::calculatePhasePressureDiff_(upIdx,
+                                                             dnIdx,
+                                                             pressureDifferenceIn,
+                                                             intQuantsIn,
+                                                             intQuantsEx,
+                                                             phaseIdx,
+                                                             interiorDofIdx,
+                                                             exteriorDofIdx,
+                                                             nbInfoIn.Vin,
+                                                             nbInfoIn.Vex,
+                                                             globalIndexIn,
+                                                             globalIndexEx,
+                                                             nbInfoIn.dZg,
+                                                             nbInfoIn.thpres);
+
+            // the pressure difference seen from the exterior cell only contributes its
+            // derivatives: its value is the negative of the interior one.
+            short upIdxEx;
+            short dnIdxEx;
+            Evaluation pressureDifferenceEx;
+            ExtensiveQuantities::calculatePhasePressureDiff_(upIdxEx,
+                                                             dnIdxEx,
+                                                             pressureDifferenceEx,
+                                                             intQuantsEx,
+                                                             intQuantsIn,
+                                                             phaseIdx,
+                                                             interiorDofIdx,
+                                                             exteriorDofIdx,
+                                                             nbInfoEx.Vin,
+                                                             nbInfoEx.Vex,
+                                                             globalIndexEx,
+                                                             globalIndexIn,
+                                                             nbInfoEx.dZg,
+                                                             nbInfoEx.thpres);
+
+            FaceEvaluation pressureDifference = liftToFace_(pressureDifferenceIn, /*offset=*/0);
+            for (unsigned varIdx = 0; varIdx < numEq; ++varIdx)
+                pressureDifference.setDerivative(numEq + varIdx, -pressureDifferenceEx.derivative(varIdx));
+
+            const bool upIsIn = (upIdx == interiorDofIdx);
+            const IntensiveQuantities& up = upIsIn ? intQuantsIn : intQuantsEx;
+            const unsigned upOffset = upIsIn ? 0 : numEq;
+
+            FaceEvaluation darcyFlux = 0.0;
+            if (pressureDifference != 0) {
+                darcyFlux = pressureDifference
+                    * liftToFace_(up.mobility(phaseIdx, facedir), upOffset)
+                    * liftToFace_(up.rockCompTransMultiplier(), upOffset)
+                    * (-trans / faceArea);
+            }
+            unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
+            darcy[conti0EqIdx + activeCompIdx] = darcyFlux.value() * faceArea;
+
+            unsigned pvtRegionIdx = up.pvtRegionIndex();
+            const auto& invB = getInvB_<FluidSystem, FluidState, Evaluation>(up.fluidState(), phaseIdx, pvtRegionIdx);
+            const FaceEvaluation surfaceVolumeFlux = liftToFace_(invB, upOffset) * darcyFlux;
+            evalFacePhaseFluxes_(flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, up.fluidState(), upOffset);
+        }
+    }
+
+    /*!
+     * \brief Compute the fluxes over a batch of interior faces.
+     *
+     * The result is the same as calling computeFaceFlux() for each face of the batch,
+     * but the faces are processed in lock step: The quantities of the upstream cells
+     * are gathered into the lanes of FaceBatchEvaluation objects, the upstream cell is
+     * selected using masks and the arithmetic is done by loops over the lanes which
+     * the compiler maps to SIMD instructions. Only the pressure differences are
+     * computed face by face because they are provided by the extensive quantities.
+     *
+     * \tparam width The number of lanes, i.e., the maximum number of faces of a batch
+     * \param flux The fluxes from the interior to the exterior cells of the faces
+     * \param darcy The volumetric fluxes of the phases (values only)
+     * \param lanes The input for the faces of the batch
+     * \param numFaces The number of faces of the batch
+     */
+    template <unsigned width>
+    static void computeFaceFluxBatch(FaceRateVector* flux,
+                                     RateVector* darcy,
+                                     const FaceBatchLane* lanes,
+                                     unsigned numFaces)
+    {
+        OPM_TIMEBLOCK_LOCAL(computeFaceFluxBatch);
+        static_assert(enableFaceFluxKernel,
+                      "The face based flux kernel does not support the enabled modules.");
+        assert(numFaces <= width);
+
+        using FaceBatch = FaceBatchEvaluation<Scalar, 2*numEq, width>;
+        using CellBatch = FaceBatchEvaluation<Scalar, numEq, width>;
+        using Lanes = typename FaceBatch::Lanes;
+        using Mask = typename FaceBatch::Mask;
+
+        std::array<FaceBatch, numEq> fluxBatch;
+        for (auto& compFlux : fluxBatch)
+            compFlux.clear();
+
+        // the unused lanes are zero and thus do not produce any flux
+        Lanes transFactor;
+        transFactor.fill(0.0);
+        for (unsigned lane = 0; lane < numFaces; ++lane) {
+            transFactor[lane] = -lanes[lane].nbInfoIn->trans / lanes[lane].nbInfoIn->faceArea;
+            darcy[lane] = 0.0;
+        }
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            // gather the pressure differences and the quantities of the upstream cells
+            FaceBatch pressureDifference;
+            CellBatch mobility;
+            CellBatch rockCompTransMultiplier;
+            CellBatch invB;
+            pressureDifference.clear();
+            mobility.clear();
+            rockCompTransMultiplier.clear();
+            invB.clear();
+            Mask upIsIn;
+            upIsIn.fill(true);
+            std::array<const IntensiveQuantities*, width> up;
+            up.fill(nullptr);
+            std::array<unsigned, width> pvtRegionIdx;
+            pvtRegionIdx.fill(0);
+            for (unsigned lane = 0; lane < numFaces; ++lane) {
+                const FaceBatchLane& face = lanes[lane];
+                short interiorDofIdx = 0; // NB
+                short exteriorDofIdx = 1; // NB
+                short upIdx;
+                short dnIdx;
+                Evaluation pressureDifferenceIn;
+                ExtensiveQuantities::calculatePhasePressureDiff_(upIdx,
+                                                                 dnIdx,
+                                                                 pressureDifferenceIn,
+                                                                 *face.intQuantsIn,
+                                                                 *face.intQuantsEx,
+                                                                 phaseIdx,
+                                                                 interiorDofIdx,
+                                                                 exteriorDofIdx,
+                                                                 face.nbInfoIn->Vin,
+                                                                 face.nbInfoIn->Vex,
+                                                                 face.globalIndexIn,
+                                                                 face.globalIndexEx,
+                                                                 face.nbInfoIn->dZg,
+                                                                 face.nbInfoIn->thpres);
+
+                short upIdxEx;
+                short dnIdxEx;
+                Evaluation pressureDifferenceEx;
+                ExtensiveQuantities::calculatePhasePressureDiff_(upIdxEx,
+                                                                 dnIdxEx,
+                                                                 pressureDifferenceEx,
+                                                                 *face.intQuantsEx,
+                                                                 *face.intQuantsIn,
+                                                                 phaseIdx,
+                                                                 interiorDofIdx,
+                                                                 exteriorDofIdx,
+                                                                 face.nbInfoEx->Vin,
+                                                                 face.nbInfoEx->Vex,
+                                                                 face.globalIndexEx,
+                                                                 face.globalIndexIn,
+                                                                 face.nbInfoEx->dZg,
+                                                                 face.nbInfoEx->thpres);
+
+                FaceEvaluation facePressureDifference = liftToFace_(pressureDifferenceIn, /*offset=*/0);
+                for (unsigned varIdx = 0; varIdx < numEq; ++varIdx)
+                    facePressureDifference.setDerivative(numEq + varIdx, -pressureDifferenceEx.derivative(varIdx));
+                pressureDifference.setLane(lane, facePressureDifference);
+
+                upIsIn[lane] = (upIdx == interiorDofIdx);
+                up[lane] = upIsIn[lane] ? face.intQuantsIn : face.intQuantsEx;
+                pvtRegionIdx[lane] = up[lane]->pvtRegionIndex();
+                mobility.setLane(lane, up[lane]->mobility(phaseIdx, face.nbInfoIn->faceDirection));
+                rockCompTransMultiplier.setLane(lane, up[lane]->rockCompTransMultiplier());
+                invB.setLane(lane, getInvB_<FluidSystem, FluidState, Evaluation>(up[lane]->fluidState(),
+                                                                                  phaseIdx,
+                                                                                  pvtRegionIdx[lane]));
+            }
+
+            Mask nonZero;
+            for (unsigned lane = 0; lane < width; ++lane)
+                nonZero[lane] = (pressureDifference.value(lane) != 0.0);
+
+            FaceBatch upQuantity;
+            FaceBatch darcyFlux = pressureDifference;
+            upQuantity.assignUpwind(mobility, upIsIn);
+            darcyFlux *= upQuantity;
+            upQuantity.assignUpwind(rockCompTransMultiplier, upIsIn);
+            darcyFlux *= upQuantity;
+            darcyFlux *= transFactor;
+            darcyFlux.select(nonZero);
+
+            unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
+            for (unsigned lane = 0; lane < numFaces; ++lane)
+                darcy[lane][conti0EqIdx + activeCompIdx] = darcyFlux.value(lane) * lanes[lane].nbInfoIn->faceArea;
+
+            FaceBatch surfaceVolumeFlux;
+            surfaceVolumeFlux.assignUpwind(invB, upIsIn);
+            surfaceVolumeFlux *= darcyFlux;
+            evalFaceBatchPhaseFluxes_<width>(fluxBatch, phaseIdx, pvtRegionIdx, surfaceVolumeFlux,
+                                             up, upIsIn, numFaces);
+        }
+
+        // scatter the lanes to the rate vectors of the faces
+        for (unsigned lane = 0; lane < numFaces; ++lane)
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                fluxBatch[eqIdx].getLane(lane, flux[lane][eqIdx]);
+    }
+
     template <class BoundaryConditionData>
     static void computeBoundaryFlux(RateVector& bdyFlux,
                                     const Problem& problem,
@@ -687,8 +1079,8 @@ public:
      * \brief Helper function to calculate the flux of mass in terms of conservation
      *        quantities via specific fluid phase over a face.
      */
-    template <class UpEval, class Eval,class FluidState>
-    static void evalPhaseFluxes_(RateVector& flux,
+    template <class UpEval, class Eval, class FluidState, class FluxVector>
+    static void evalPhaseFluxes_(FluxVector& flux,
                                  unsigned phaseIdx,
                                  unsigned pvtRegionIdx,
                                  const Eval& surfaceVolumeFlux,
@@ -748,6 +1140,142 @@ public:
         }
     }
 
+    /*!
+     * \brief Convert an evaluation of a cell to one which can be used by the face based
+     *        flux kernel.
+     *
+     * The derivatives are shifted by offset, i.e., offset is 0 for the interior and
+     * numEq for the exterior cell of the face.
+     */
+    static FaceEvaluation liftToFace_(const Evaluation& eval, unsigned offset)
+    {
+        FaceEvaluation result(eval.value());
+        for (unsigned varIdx = 0; varIdx < numEq; ++varIdx)
+            result.setDerivative(offset + varIdx, eval.derivative(varIdx));
+
+        return result;
+    }
+
+    /*!
+     * \brief Variant of evalPhaseFluxes_() for the face based flux kernel.
+     */
+    template <class FluidState>
+    static void evalFacePhaseFluxes_(FaceRateVector& flux,
+                                     unsigned phaseIdx,
+                                     unsigned pvtRegionIdx,
+                                     const FaceEvaluation& surfaceVolumeFlux,
+                                     const FluidState& upFs,
+                                     unsigned upOffset)
+    {
+        unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
+
+        if (blackoilConserveSurfaceVolume)
+            flux[conti0EqIdx + activeCompIdx] += surfaceVolumeFlux;
+        else
+            flux[conti0EqIdx + activeCompIdx] += surfaceVolumeFlux*FluidSystem::referenceDensity(phaseIdx, pvtRegionIdx);
+
+        const auto addDissolved = [&](unsigned compIdx, unsigned refPhaseIdx, const Evaluation& ratio)
+        {
+            unsigned activeDissolvedCompIdx = Indices::canonicalToActiveComponentIndex(compIdx);
+            const FaceEvaluation dissolvedFlux = liftToFace_(ratio, upOffset)*surfaceVolumeFlux;
+            if (blackoilConserveSurfaceVolume)
+                flux[conti0EqIdx + activeDissolvedCompIdx] += dissolvedFlux;
+            else
+                flux[conti0EqIdx + activeDissolvedCompIdx] += dissolvedFlux*FluidSystem::referenceDensity(refPhaseIdx, pvtRegionIdx);
+        };
+
+        if (phaseIdx == oilPhaseIdx) {
+            // dissolved gas (in the oil phase).
+            if (FluidSystem::enableDissolvedGas())
+                addDissolved(gasCompIdx, gasPhaseIdx,
+                             BlackOil::getRs_<FluidSystem, FluidState, Evaluation>(upFs, pvtRegionIdx));
+        }
+        else if (phaseIdx == waterPhaseIdx) {
+            // dissolved gas (in the water phase).
+            if (FluidSystem::enableDissolvedGasInWater())
+                addDissolved(gasCompIdx, gasPhaseIdx,
+                             BlackOil::getRsw_<FluidSystem, FluidState, Evaluation>(upFs, pvtRegionIdx));
+        }
+        else if (phaseIdx == gasPhaseIdx) {
+            // vaporized oil (in the gas phase).
+            if (FluidSystem::enableVaporizedOil())
+                addDissolved(oilCompIdx, oilPhaseIdx,
+                             BlackOil::getRv_<FluidSystem, FluidState, Evaluation>(upFs, pvtRegionIdx));
+
+            // vaporized water (in the gas phase).
+            if (FluidSystem::enableVaporizedWater())
+                addDissolved(waterCompIdx, waterPhaseIdx,
+                             BlackOil::getRvw_<FluidSystem, FluidState, Evaluation>(upFs, pvtRegionIdx));
+        }
+    }
+
+    /*!
+     * \brief Variant of evalFacePhaseFluxes_() for the batched flux kernel.
+     */
+    template <unsigned width>
+    static void evalFaceBatchPhaseFluxes_(std::array<FaceBatchEvaluation<Scalar, 2*numEq, width>, numEq>& flux,
+                                          unsigned phaseIdx,
+                                          const std::array<unsigned, width>& pvtRegionIdx,
+                                          const FaceBatchEvaluation<Scalar, 2*numEq, width>& surfaceVolumeFlux,
+                                          const std::array<const IntensiveQuantities*, width>& up,
+                                          const std::array<bool, width>& upIsIn,
+                                          unsigned numFaces)
+    {
+        using FaceBatch = FaceBatchEvaluation<Scalar, 2*numEq, width>;
+        using CellBatch = FaceBatchEvaluation<Scalar, numEq, width>;
+
+        const auto addComponentFlux = [&](unsigned compIdx, unsigned refPhaseIdx, FaceBatch& compFlux)
+        {
+            if (!blackoilConserveSurfaceVolume) {
+                typename FaceBatch::Lanes referenceDensity;
+                referenceDensity.fill(0.0);
+                for (unsigned lane = 0; lane < numFaces; ++lane)
+                    referenceDensity[lane] = FluidSystem::referenceDensity(refPhaseIdx, pvtRegionIdx[lane]);
+                compFlux *= referenceDensity;
+            }
+            flux[conti0EqIdx + Indices::canonicalToActiveComponentIndex(compIdx)] += compFlux;
+        };
+
+        const auto addDissolved = [&](unsigned compIdx, unsigned refPhaseIdx, const auto& getRatio)
+        {
+            CellBatch ratio;
+            ratio.clear();
+            for (unsigned lane = 0; lane < numFaces; ++lane)
+                ratio.setLane(lane, getRatio(up[lane]->fluidState(), pvtRegionIdx[lane]));
+            FaceBatch dissolvedFlux;
+            dissolvedFlux.assignUpwind(ratio, upIsIn);
+            dissolvedFlux *= surfaceVolumeFlux;
+            addComponentFlux(compIdx, refPhaseIdx, dissolvedFlux);
+        };
+
+        FaceBatch phaseFlux = surfaceVolumeFlux;
+        addComponentFlux(FluidSystem::solventComponentIndex(phaseIdx), phaseIdx, phaseFlux);
+
+        if (phaseIdx == oilPhaseIdx) {
+            // dissolved gas (in the oil phase).
+            if (FluidSystem::enableDissolvedGas())
+                addDissolved(gasCompIdx, gasPhaseIdx, [](const FluidState& fs, unsigned regionIdx)
+                             { return BlackOil::getRs_<FluidSystem, FluidState, Evaluation>(fs, regionIdx); });
+        }
+        else if (phaseIdx == waterPhaseIdx) {
+            // dissolved gas (in the water phase).
+            if (FluidSystem::enableDissolvedGasInWater())
+                addDissolved(gasCompIdx, gasPhaseIdx, [](const FluidState& fs, unsigned regionIdx)
+                             { return BlackOil::getRsw_<FluidSystem, FluidState, Evaluation>(fs, regionIdx); });
+        }
+        else if (phaseIdx == gasPhaseIdx) {
+            // vaporized oil (in the gas phase).
+            if (FluidSystem::enableVaporizedOil())
+                addDissolved(oilCompIdx, oilPhaseIdx, [](const FluidState& fs, unsigned regionIdx)
+                             { return BlackOil::getRv_<FluidSystem, FluidState, Evaluation>(fs, regionIdx); });
+
+            // vaporized water (in the gas phase).
+            if (FluidSystem::enableVaporizedWater())
+                addDissolved(waterCompIdx, waterPhaseIdx, [](const FluidState& fs, unsigned regionIdx)
+                             { return BlackOil::getRvw_<FluidSystem, FluidState, Evaluation>(fs, regionIdx); });
+        }
+    }
+
     /*!
      * \brief Helper function to convert the mass-related parts of a Dune::FieldVector
      *        that stores conservation quantities in terms of "surface-volume" to the
@@ -456,8 +456,14 @@ protected:
         else
             wasSwitched_[globalDofIdx] = nextValue.adaptPrimaryVariables(this->problem(), globalDofIdx, waterSaturationMax_, waterOnlyThreshold_);
 
-        if (wasSwitched_[globalDofIdx])
+        if (wasSwitched_[globalDofIdx]) {
+            // the sub-domains of the nonlinear domain decomposition are updated
+            // concurrently
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
             ++ numPriVarsSwitched_;
+        }
         if(projectSaturations_){
             nextValue.chopAndNormalizeSaturations();
         }
@@ -480,8 +486,9 @@ private:
     Scalar tempMin_;
 
     // keep track of cells where the primary variable meaning has changed
-    // to detect and hinder oscillations
-    std::vector<bool> wasSwitched_;
+    // to detect and hinder oscillations. (not std::vector<bool> because the
+    // entries may be written concurrently.)
+    std::vector<char> wasSwitched_;
 };
 } // namespace Opm
 
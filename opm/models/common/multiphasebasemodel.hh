@@ -206,7 +206,7 @@ public:
 
         storage = 0;
 
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->gridView());
+        typename ElementChunks<GridView>::Cursor cursor;
         std::mutex mutex;
 #ifdef _OPENMP
 #pragma omp parallel
@@ -216,13 +216,11 @@ public:
             // moved in front of the #pragma!
             unsigned threadId = ThreadManager::threadId();
             ElementContext elemCtx(this->simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
             EqVector tmp;
 
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
+            this->elementChunks().forEach(cursor, [&](const Element& elem) {
                 if (elem.partitionType() != Dune::InteriorEntity)
-                    continue; // ignore ghost and overlap elements
+                    return; // ignore ghost and overlap elements
 
                 elemCtx.updateStencil(elem);
                 elemCtx.updateIntensiveQuantities(/*timeIdx=*/0);
@@ -245,7 +243,7 @@ public:
                     storage += tmp;
                     mutex.unlock();
                 }
-            }
+            });
         }
 
         storage = this->gridView_.comm().sum(storage);
@@ -0,0 +1,183 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::FaceBatchEvaluation
+ */
+#ifndef EWOMS_FACE_BATCH_EVALUATION_HH
+#define EWOMS_FACE_BATCH_EVALUATION_HH
+
+#include <array>
+#include <cassert>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief The values and derivatives of a quantity for a batch of faces.
+ *
+ * Lane i holds the quantity of the i-th face of the batch. The data is stored as a
+ * structure of arrays, i.e., the values of all lanes are contiguous and so is each
+ * derivative. All arithmetic operations are loops over the lanes without any
+ * dependencies between the iterations, which the compiler maps to SIMD instructions.
+ *
+ * \tparam Scalar The floating point type of the values and derivatives
+ * \tparam numDerivs The number of derivatives of each lane
+ * \tparam width The number of lanes
+ */
+template <class Scalar, int numDerivs, unsigned width>
+class FaceBatchEvaluation
+{
+public:
+    using Lanes = std::array<Scalar, width>;
+    using Mask = std::array<bool, width>;
+
+    static constexpr unsigned numLanes = width;
+
+    /*!
+     * \brief Set the values and all derivatives of all lanes to zero.
+     */
+    void clear()
+    {
+        value_.fill(0.0);
+        for (auto& deriv : derivatives_)
+            deriv.fill(0.0);
+    }
+
+    const Lanes& value() const
+    { return value_; }
+
+    Scalar value(unsigned lane) const
+    { return value_[lane]; }
+
+    Scalar derivative(unsigned lane, int varIdx) const
+    { return derivatives_[varIdx][lane]; }
+
+    /*!
+     * \brief Copy a dense automatic differentiation object into a lane.
+     */
+    template <class Eval>
+    void setLane(unsigned lane, const Eval& eval)
+    {
+        static_assert(Eval::numVars == numDerivs,
+                      "The number of derivatives must be the same");
+        assert(lane < width);
+        value_[lane] = eval.value();
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            derivatives_[varIdx][lane] = eval.derivative(varIdx);
+    }
+
+    /*!
+     * \brief Copy a lane into a dense automatic differentiation object.
+     */
+    template <class Eval>
+    void getLane(unsigned lane, Eval& eval) const
+    {
+        static_assert(Eval::numVars == numDerivs,
+                      "The number of derivatives must be the same");
+        assert(lane < width);
+        eval.setValue(value_[lane]);
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            eval.setDerivative(varIdx, derivatives_[varIdx][lane]);
+    }
+
+    /*!
+     * \brief Assign the quantities of the upstream cells of the faces.
+     *
+     * The derivatives of the cell quantities are placed in the first half of the
+     * derivatives if upIsIn is set for a lane and in the second half otherwise, while
+     * the other half is zeroed.
+     */
+    template <int numCellDerivs>
+    void assignUpwind(const FaceBatchEvaluation<Scalar, numCellDerivs, width>& cellEval,
+                      const Mask& upIsIn)
+    {
+        static_assert(2*numCellDerivs == numDerivs,
+                      "The upstream quantity must depend on the variables of a single cell");
+        value_ = cellEval.value();
+        for (int varIdx = 0; varIdx < numCellDerivs; ++varIdx) {
+            auto& derivIn = derivatives_[varIdx];
+            auto& derivEx = derivatives_[numCellDerivs + varIdx];
+            for (unsigned lane = 0; lane < width; ++lane) {
+                const Scalar d = cellEval.derivative(lane, varIdx);
+                derivIn[lane] = upIsIn[lane] ? d : Scalar(0.0);
+                derivEx[lane] = upIsIn[lane] ? Scalar(0.0) : d;
+            }
+        }
+    }
+
+    /*!
+     * \brief Set the lanes for which the mask is not set to zero.
+     */
+    void select(const Mask& mask)
+    {
+        for (unsigned lane = 0; lane < width; ++lane)
+            value_[lane] = mask[lane] ? value_[lane] : Scalar(0.0);
+        for (auto& deriv : derivatives_)
+            for (unsigned lane = 0; lane < width; ++lane)
+                deriv[lane] = mask[lane] ? deriv[lane] : Scalar(0.0);
+    }
+
+    FaceBatchEvaluation& operator+=(const FaceBatchEvaluation& other)
+    {
+        for (unsigned lane = 0; lane < width; ++lane)
+            value_[lane] += other.value_[lane];
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (unsigned lane = 0; lane < width; ++lane)
+                derivatives_[varIdx][lane] += other.derivatives_[varIdx][lane];
+        return *this;
+    }
+
+    //! multiply each lane by a constant
+    FaceBatchEvaluation& operator*=(const Lanes& factor)
+    {
+        for (unsigned lane = 0; lane < width; ++lane)
+            value_[lane] *= factor[lane];
+        for (auto& deriv : derivatives_)
+            for (unsigned lane = 0; lane < width; ++lane)
+                deriv[lane] *= factor[lane];
+        return *this;
+    }
+
+    FaceBatchEvaluation& operator*=(const FaceBatchEvaluation& other)
+    {
+        // product rule: (u*v)' = u'*v + u*v'
+        for (int varIdx = 0; varIdx < numDerivs; ++varIdx)
+            for (unsigned lane = 0; lane < width; ++lane)
+                derivatives_[varIdx][lane] =
+                    derivatives_[varIdx][lane]*other.value_[lane]
+                    + value_[lane]*other.derivatives_[varIdx][lane];
+        for (unsigned lane = 0; lane < width; ++lane)
+            value_[lane] *= other.value_[lane];
+        return *this;
+    }
+
+private:
+    alignas(64) Lanes value_;
+    alignas(64) std::array<Lanes, numDerivs> derivatives_;
+};
+
+} // namespace Opm
+
+#endif
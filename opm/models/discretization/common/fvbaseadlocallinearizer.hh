@@ -39,6 +39,8 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
+
 namespace Opm {
 // forward declaration
 template<class TypeTag>
@@ -138,6 +140,11 @@ public:
         simulatorPtr_ = &simulator;
         delete internalElemContext_;
         internalElemContext_ = new ElementContext(simulator);
+
+        // allocate the storage for the largest stencil of the grid
+        const auto& model = simulator.model();
+        jacobian_.setSize(model.maxStencilNumDof(), model.maxStencilNumPrimaryDof());
+        residual_.reserve(model.maxStencilNumDof());
     }
 
     /*!
@@ -251,17 +258,26 @@ protected:
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
 
         residual_.resize(numDof);
-        if (jacobian_.N() != numDof || jacobian_.M() != numPrimaryDof)
-          jacobian_.setSize(numDof, numPrimaryDof);
+
+        // the local Jacobian is only reallocated if the stencil is larger than all
+        // previous ones. only its upper left part is used for smaller stencils
+        if (jacobian_.N() < numDof || jacobian_.M() < numPrimaryDof)
+            jacobian_.setSize(std::max<size_t>(jacobian_.N(), numDof),
+                              std::max<size_t>(jacobian_.M(), numPrimaryDof));
     }
 
     /*!
      * \brief Reset the all relevant internal attributes to 0
      */
-    void reset_(const ElementContext&)
+    void reset_(const ElementContext& elemCtx)
     {
         residual_ = 0.0;
-        jacobian_ = 0.0;
+
+        size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
+        size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx)
+            for (unsigned dof2Idx = 0; dof2Idx < numDof; ++ dof2Idx)
+                jacobian_[dof2Idx][primaryDofIdx] = 0.0;
     }
 
     /*!
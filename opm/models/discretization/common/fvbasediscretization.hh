@@ -45,7 +45,11 @@
 #include "fvbaseintensivequantities.hh"
 #include "fvbaseextensivequantities.hh"
 #include "baseauxiliarymodule.hh"
+#include "reorderedmapper.hh"
+#include "stencilcache.hh"
+#include "fvbasetimestepcontroller.hh"
 
+#include <opm/models/parallel/elementchunks.hh>
 #include <opm/models/parallel/gridcommhandles.hh>
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/simulators/linalg/nullborderlistmanager.hh>
@@ -65,9 +69,11 @@
 
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <limits>
 #include <list>
+#include <memory>
 #include <stdexcept>
 #include <sstream>
 #include <string>
@@ -239,6 +245,10 @@ struct MinTimeStepSize<TypeTag, TTag::FvBaseDiscretization>
     static constexpr type value = 0.0;
 };
 
+//! By default, the time step size is chosen based on the number of Newton iterations
+template<class TypeTag>
+struct TimeStepController<TypeTag, TTag::FvBaseDiscretization> { using type = FvBaseTimeStepController<TypeTag>; };
+
 //! Disable grid adaptation by default
 template<class TypeTag>
 struct EnableGridAdaptation<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
@@ -247,6 +257,10 @@ struct EnableGridAdaptation<TypeTag, TTag::FvBaseDiscretization> { static conste
 template<class TypeTag>
 struct OutputDir<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = "."; };
 
+//! Keep the order of the grid view unless ReorderedMapper is told otherwise
+template<class TypeTag>
+struct DofOrdering<TypeTag, TTag::FvBaseDiscretization> { static constexpr auto value = "natural"; };
+
 //! Enable the VTK output by default
 template<class TypeTag>
 struct EnableVtkOutput<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = true; };
@@ -265,6 +279,10 @@ struct VtkOutputFormat<TypeTag, TTag::FvBaseDiscretization> { static constexpr i
 template<class TypeTag>
 struct EnableStorageCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
+// recompute the stencils of the elements on demand by default
+template<class TypeTag>
+struct EnableStencilCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
 // disable constraints by default
 template<class TypeTag>
 struct EnableConstraints<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
@@ -374,6 +392,7 @@ class FvBaseDiscretization
     using GridCommHandleFactory = GetPropType<TypeTag, Properties::GridCommHandleFactory>;
     using NewtonMethod = GetPropType<TypeTag, Properties::NewtonMethod>;
     using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
+    using StencilCacheType = StencilCache<GridView, Stencil, ElementMapper>;
 
     using LocalLinearizer = GetPropType<TypeTag, Properties::LocalLinearizer>;
     using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
@@ -450,6 +469,7 @@ public:
         , gridView_(simulator.gridView())
         , elementMapper_(gridView_, Dune::mcmgElementLayout())
         , vertexMapper_(gridView_, Dune::mcmgVertexLayout())
+        , elementChunks_(gridView_)
         , newtonMethod_(simulator)
         , localLinearizer_(ThreadManager::maxThreads())
         , linearizer_(new Linearizer())
@@ -466,9 +486,14 @@ public:
 
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
 
+        // the problem is not yet available, so finishInit() decides whether the intensive
+        // quantities of the previous time levels are required if the storage term is
+        // cached
+        storeOldIntensiveQuantities_ = !enableStorageCache_;
+
         size_t numDof = asImp_().numGridDof();
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
-            if (storeIntensiveQuantities()) {
+            if (storeIntensiveQuantities() && (timeIdx == 0 || storeOldIntensiveQuantities_)) {
                 intensiveQuantityCache_[timeIdx].resize(numDof);
                 intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof, /*value=*/false);
             }
@@ -514,7 +539,11 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableThermodynamicHints, "Enable thermodynamic hints");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntensiveQuantityCache, "Turn on caching of intensive quantities");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStorageCache, "Store previous storage terms and avoid re-calculating them.");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStencilCache, "Compute the finite volume geometry of each element once and store it.");
         EWOMS_REGISTER_PARAM(TypeTag, std::string, OutputDir, "The directory to which result files are written");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, DofOrdering,
+                             "The numbering of the degrees of freedom if ReorderedMapper is used as "
+                             "the DOF mapper. Possible values: 'natural', 'rcm', 'morton'");
     }
 
     /*!
@@ -522,6 +551,11 @@ public:
      */
     void finishInit()
     {
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnableStencilCache))
+            stencilCache_ = std::make_unique<StencilCacheType>(gridView_, elementMapper_,
+                                                               [this]() { return asImp_().createStencil(); });
+        updateMaxStencilSize_();
+
         // initialize the volume of the finite volumes to zero
         size_t numDof = asImp_().numGridDof();
         dofTotalVolume_.resize(numDof);
@@ -576,6 +610,12 @@ public:
         for (unsigned threadId = 0; threadId < ThreadManager::maxThreads(); ++threadId)
             localLinearizer_[threadId].init(simulator_);
 
+        // if the storage term is cached and it can be recycled from the first iteration
+        // of a time step, the intensive quantities of the previous time levels are never
+        // accessed
+        storeOldIntensiveQuantities_ =
+            !enableStorageCache_ || !simulator_.problem().recycleFirstIterationStorage();
+
         resizeAndResetIntensiveQuantitiesCache_();
         if (storeIntensiveQuantities()) {
             // invalidate all cached intensive quantities
@@ -634,6 +674,7 @@ public:
         // also set the solutions of the "previous" time steps to the initial solution.
         for (unsigned timeIdx = 1; timeIdx < historySize; ++timeIdx)
             solution(timeIdx) = solution(/*timeIdx=*/0);
+        previousStorageCached_ = false;
 
         simulator_.problem().initialSolutionApplied();
 
@@ -704,20 +745,25 @@ public:
      */
     const IntensiveQuantities* cachedIntensiveQuantities(unsigned globalIdx, unsigned timeIdx) const
     {
-        if (!enableIntensiveQuantityCache_ || !intensiveQuantityCacheUpToDate_[timeIdx][globalIdx]) {
+        if (!enableIntensiveQuantityCache_)
             return nullptr;
-        }
+
+        unsigned slotIdx = intensiveQuantityStorageSlot_(globalIdx, timeIdx);
 
         // With the storage cache enabled, usually only the
         // intensive quantities for the most recent time step are
         // cached. However, this may be false for some Problem
         // variants, so we should check if the cache exists for
         // the timeIdx in question.
-        if (timeIdx > 0 && enableStorageCache_ && intensiveQuantityCache_[timeIdx].empty()) {
+        if (timeIdx > 0 && enableStorageCache_ && intensiveQuantityCache_[slotIdx].empty()) {
             return nullptr;
         }
 
-        return &intensiveQuantityCache_[timeIdx][globalIdx];
+        if (!intensiveQuantityCacheUpToDate_[slotIdx][globalIdx]) {
+            return nullptr;
+        }
+
+        return &intensiveQuantityCache_[slotIdx][globalIdx];
     }
 
     /*!
@@ -735,8 +781,17 @@ public:
         if (!storeIntensiveQuantities())
             return;
 
-        intensiveQuantityCache_[timeIdx][globalIdx] = intQuants;
-        intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = 1;
+        unsigned slotIdx = intensiveQuantityCacheSlot_[timeIdx];
+        if (intensiveQuantityCache_[slotIdx].empty())
+            return; // the intensive quantities of this time level are not stored
+
+        if (timeIdx == 0)
+            intensiveQuantityCacheAliased_[globalIdx] = 0;
+        else
+            unaliasIntensiveQuantities_(globalIdx);
+
+        intensiveQuantityCache_[slotIdx][globalIdx] = intQuants;
+        intensiveQuantityCacheUpToDate_[slotIdx][globalIdx] = 1;
     }
 
     /*!
@@ -753,7 +808,16 @@ public:
         if (!storeIntensiveQuantities())
             return;
 
-        intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = newValue ? 1 : 0;
+        auto& upToDate = intensiveQuantityCacheUpToDate_[intensiveQuantityCacheSlot_[timeIdx]];
+        if (upToDate.empty())
+            return; // the intensive quantities of this time level are not stored
+
+        if (timeIdx == 0 && !newValue)
+            intensiveQuantityCacheAliased_[globalIdx] = 0;
+        else
+            unaliasIntensiveQuantities_(globalIdx);
+
+        upToDate[globalIdx] = newValue ? 1 : 0;
     }
 
     /*!
@@ -764,9 +828,19 @@ public:
     void invalidateIntensiveQuantitiesCache(unsigned timeIdx) const
     {
         if (storeIntensiveQuantities()) {
-            std::fill(intensiveQuantityCacheUpToDate_[timeIdx].begin(),
-                      intensiveQuantityCacheUpToDate_[timeIdx].end(),
-                      /*value=*/0);
+            if (timeIdx == 0) {
+                // the aliased entries become invalid as well
+                std::fill(intensiveQuantityCacheAliased_.begin(),
+                          intensiveQuantityCacheAliased_.end(),
+                          /*value=*/0);
+            }
+            else if (timeIdx == 1) {
+                for (unsigned globalIdx = 0; globalIdx < intensiveQuantityCacheAliased_.size(); ++globalIdx)
+                    unaliasIntensiveQuantities_(globalIdx);
+            }
+
+            auto& upToDate = intensiveQuantityCacheUpToDate_[intensiveQuantityCacheSlot_[timeIdx]];
+            std::fill(upToDate.begin(), upToDate.end(), /*value=*/0);
         }
     }
 
@@ -775,18 +849,16 @@ public:
         invalidateIntensiveQuantitiesCache(timeIdx);
 
         // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+        typename ElementChunks<GridView>::Cursor cursor;
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
         {
             ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
+            elementChunks_.forEach(cursor, [&](const Element& elem) {
                 elemCtx.updatePrimaryStencil(elem);
                 elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
-            }
+            });
         }
     }
 
@@ -823,7 +895,9 @@ public:
     /*!
      * \brief Move the intensive quantities for a given time index to the back.
      *
-     * This method should only be called by the time discretization.
+     * This method should only be called by the time discretization. The buffers of the
+     * time indices are rotated instead of copied. Afterwards, the intensive quantities
+     * for time index 0 refer to the ones of time index 1 until they are updated.
      *
      * \param numSlots The number of time step slots for which the
      *                 hints should be shifted.
@@ -843,11 +917,33 @@ public:
             return;
         }
 
+        if (previousStorageCached_) {
+            // the storage term of the previous time level has been computed from the
+            // intensive quantities before they would have been shifted. make sure that
+            // the outdated intensive quantities of the previous time levels are not used
+            // by accident.
+            for (unsigned timeIdx = 1; timeIdx < historySize; ++timeIdx)
+                invalidateIntensiveQuantitiesCache(timeIdx);
+            return;
+        }
+
         assert(numSlots > 0);
 
-        for (unsigned timeIdx = 0; timeIdx < historySize - numSlots; ++ timeIdx) {
-            intensiveQuantityCache_[timeIdx + numSlots] = intensiveQuantityCache_[timeIdx];
-            intensiveQuantityCacheUpToDate_[timeIdx + numSlots] = intensiveQuantityCacheUpToDate_[timeIdx];
+        if (historySize < 2)
+            return;
+
+        for (unsigned slotIdx = 0; slotIdx < numSlots; ++slotIdx) {
+            // the entries for time index 0 which are still stored for time index 1 must
+            // be copied before the buffer of time index 1 is recycled
+            for (unsigned globalIdx = 0; globalIdx < intensiveQuantityCacheAliased_.size(); ++globalIdx)
+                unaliasIntensiveQuantities_(globalIdx);
+
+            std::rotate(intensiveQuantityCacheSlot_.begin(),
+                        intensiveQuantityCacheSlot_.end() - 1,
+                        intensiveQuantityCacheSlot_.end());
+            std::fill(intensiveQuantityCacheAliased_.begin(),
+                      intensiveQuantityCacheAliased_.end(),
+                      /*value=*/1);
         }
 
         // the cache for the most recent time indices do not need to be invalidated
@@ -934,7 +1030,7 @@ public:
         dest = 0;
 
         std::mutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+        typename ElementChunks<GridView>::Cursor cursor;
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -943,13 +1039,11 @@ public:
             // moved in front of the #pragma!
             unsigned threadId = ThreadManager::threadId();
             ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
             LocalEvalBlockVector residual, storageTerm;
 
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
+            elementChunks_.forEach(cursor, [&](const Element& elem) {
                 if (elem.partitionType() != Dune::InteriorEntity)
-                    continue;
+                    return;
 
                 elemCtx.updateAll(elem);
                 residual.resize(elemCtx.numDof(/*timeIdx=*/0));
@@ -964,7 +1058,7 @@ public:
                         dest[globalI][eqIdx] += Toolbox::value(residual[dofIdx][eqIdx]);
                 }
                 mutex.unlock();
-            }
+            });
         }
 
         // add up the residuals on the process borders
@@ -995,7 +1089,7 @@ public:
         storage = 0;
 
         std::mutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
+        typename ElementChunks<GridView>::Cursor cursor;
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -1004,17 +1098,15 @@ public:
             // moved in front of the #pragma!
             unsigned threadId = ThreadManager::threadId();
             ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
             LocalEvalBlockVector elemStorage;
 
             // in this method, we need to disable the storage cache because we want to
             // evaluate the storage term for other time indices than the most recent one
             elemCtx.setEnableStorageCache(false);
 
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
+            elementChunks_.forEach(cursor, [&](const Element& elem) {
                 if (elem.partitionType() != Dune::InteriorEntity)
-                    continue; // ignore ghost and overlap elements
+                    return; // ignore ghost and overlap elements
 
                 elemCtx.updateStencil(elem);
                 elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
@@ -1029,7 +1121,7 @@ public:
                     for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
                         storage[eqIdx] += Toolbox::value(elemStorage[dofIdx][eqIdx]);
                 mutex.unlock();
-            }
+            });
         }
 
         storage = gridView_.comm().sum(storage);
@@ -1440,8 +1532,18 @@ public:
         // at this point we can adapt the grid
         if (this->enableGridAdaptation_) {
             asImp_().adaptGrid();
+            elementChunks_.update();
+            if (stencilCache_)
+                stencilCache_->update();
+            updateMaxStencilSize_();
         }
 
+        // if the storage term is cached but cannot be recycled from the first iteration
+        // of the next time step, compute it from the intensive quantities of the current
+        // solution instead of keeping them for the previous time level
+        if (enableStorageCache_ && !simulator_.problem().recycleFirstIterationStorage())
+            asImp_().updatePreviousStorageCache_();
+
         // make the current solution the previous one.
         solution(/*timeIdx=*/1) = solution(/*timeIdx=*/0);
 
@@ -1450,6 +1552,16 @@ public:
         asImp_().shiftIntensiveQuantityCache(/*numSlots=*/1);
     }
 
+    /*!
+     * \brief Returns true iff the cached storage term for time index 1 has been computed
+     *        when the time level was advanced.
+     *
+     * In this case, the storage term of the previous time level does not need to be
+     * computed from the intensive quantities of that time level.
+     */
+    bool previousStorageCached() const
+    { return previousStorageCached_; }
+
     /*!
      * \brief Serializes the current state of the model.
      *
@@ -1570,6 +1682,53 @@ public:
     const ElementMapper& elementMapper() const
     { return elementMapper_; }
 
+    /*!
+     * \brief Returns the elements of the grid view split into chunks for threaded
+     *        loops.
+     */
+    const ElementChunks<GridView>& elementChunks() const
+    { return elementChunks_; }
+
+    /*!
+     * \brief Create a stencil for the grid view of the discretization.
+     *
+     * The stencil must be updated for an element before it can be used. Discretizations
+     * whose stencils require additional data overload this method.
+     */
+    Stencil createStencil() const
+    { return Stencil(gridView_, asImp_().dofMapper()); }
+
+    /*!
+     * \brief Returns the object which stores the stencils of all elements or nullptr if
+     *        the stencils are computed on demand.
+     */
+    const StencilCacheType* stencilCache() const
+    { return stencilCache_.get(); }
+
+    /*!
+     * \brief Returns the maximum number of degrees of freedom of the stencil of an
+     *        element of the grid.
+     *
+     * The element contexts and the local linearizers use this to allocate their
+     * storage once instead of growing it while they visit the elements.
+     */
+    size_t maxStencilNumDof() const
+    { return maxStencilNumDof_; }
+
+    /*!
+     * \brief Returns the maximum number of primary degrees of freedom of the stencil
+     *        of an element of the grid.
+     */
+    size_t maxStencilNumPrimaryDof() const
+    { return maxStencilNumPrimaryDof_; }
+
+    /*!
+     * \brief Returns the maximum number of interior faces of the stencil of an element
+     *        of the grid.
+     */
+    size_t maxStencilNumInteriorFaces() const
+    { return maxStencilNumInteriorFaces_; }
+
     /*!
      * \brief Resets the Jacobian matrix linearizer, so that the
      *        boundary types can be altered.
@@ -1689,6 +1848,17 @@ public:
         for (unsigned globalIdx = 0; globalIdx < numGridDof; ++ globalIdx)
             (*normalizedRelError)[globalIdx] /= alpha;
 
+        // the writer expects the buffers in the grid's natural numbering
+        const auto& dofMapper = asImp_().dofMapper();
+        restoreNaturalOrder(dofMapper, *relError);
+        restoreNaturalOrder(dofMapper, *normalizedRelError);
+        for (unsigned i = 0; i < numEq; ++i) {
+            restoreNaturalOrder(dofMapper, *priVars[i]);
+            restoreNaturalOrder(dofMapper, *delta[i]);
+            restoreNaturalOrder(dofMapper, *priVarWeight[i]);
+            restoreNaturalOrder(dofMapper, *def[i]);
+        }
+
         DiscBaseOutputModule::attachScalarDofData_(writer, *relError, "relative error");
         DiscBaseOutputModule::attachScalarDofData_(writer, *normalizedRelError, "normalized relative error");
 
@@ -1734,21 +1904,28 @@ public:
         }
 
         // iterate over grid
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
+        typename ElementChunks<GridView>::Cursor cursor;
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
         {
+            // the output modules only read the intensive quantities, so the ones of the
+            // cache can be used without copying them. Only the missing ones are
+            // recomputed.
             ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const auto& elem = *elemIt;
+            elemCtx.setReferToCachedIntensiveQuantities(true);
+            elementChunks_.forEach(cursor, [&](const Element& elem) {
                 if (elem.partitionType() != Dune::InteriorEntity)
                     // ignore non-interior entities
-                    continue;
-
-                if (needFullContextUpdate)
-                    elemCtx.updateAll(elem);
+                    return;
+
+                if (needFullContextUpdate) {
+                    // the output only refers to the most recent solution, so the
+                    // intensive quantities of the previous time levels are not needed
+                    elemCtx.updateStencil(elem);
+                    elemCtx.updateIntensiveQuantities(/*timeIdx=*/0);
+                    elemCtx.updateAllExtensiveQuantities();
+                }
                 else {
                     elemCtx.updatePrimaryStencil(elem);
                     elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
@@ -1760,7 +1937,7 @@ public:
                 auto modIt2 = outputModules_.begin();
                 for (; modIt2 != modEndIt; ++modIt2)
                     (*modIt2)->processElement(elemCtx);
-            }
+            });
         }
     }
 
@@ -1880,6 +2057,24 @@ public:
     }
 
 protected:
+    // determine the size of the largest stencil of the grid
+    void updateMaxStencilSize_()
+    {
+        maxStencilNumDof_ = 0;
+        maxStencilNumPrimaryDof_ = 0;
+        maxStencilNumInteriorFaces_ = 0;
+
+        ElementContext elemCtx(simulator_);
+        for (const auto& elem : elements(gridView_)) {
+            elemCtx.updateStencil(elem);
+            maxStencilNumDof_ = std::max(maxStencilNumDof_, elemCtx.numDof(/*timeIdx=*/0));
+            maxStencilNumPrimaryDof_ = std::max(maxStencilNumPrimaryDof_,
+                                                elemCtx.numPrimaryDof(/*timeIdx=*/0));
+            maxStencilNumInteriorFaces_ = std::max(maxStencilNumInteriorFaces_,
+                                                   elemCtx.numInteriorFaces(/*timeIdx=*/0));
+        }
+    }
+
     void resizeAndResetIntensiveQuantitiesCache_()
     {
         // allocate the storage cache
@@ -1890,16 +2085,83 @@ protected:
             }
         }
 
-        // allocate the intensive quantities cache
+        previousStorageCached_ = false;
+
+        // allocate the intensive quantities cache. the ones of the previous time levels
+        // are only stored if they are needed to calculate the storage term
+        for(unsigned timeIdx=0; timeIdx<historySize; ++timeIdx)
+            intensiveQuantityCacheSlot_[timeIdx] = timeIdx;
         if (storeIntensiveQuantities()) {
             size_t numDof = asImp_().numGridDof();
             for(unsigned timeIdx=0; timeIdx<historySize; ++timeIdx) {
+                if (timeIdx > 0 && !storeOldIntensiveQuantities_) {
+                    IntensiveQuantitiesVector().swap(intensiveQuantityCache_[timeIdx]);
+                    std::vector<unsigned char>().swap(intensiveQuantityCacheUpToDate_[timeIdx]);
+                    continue;
+                }
+
                 intensiveQuantityCache_[timeIdx].resize(numDof);
                 intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof);
-                invalidateIntensiveQuantitiesCache(timeIdx);
             }
+            intensiveQuantityCacheAliased_.resize(numDof);
+            for(unsigned timeIdx=0; timeIdx<historySize; ++timeIdx)
+                invalidateIntensiveQuantitiesCache(timeIdx);
         }
     }
+
+    // returns the index of the buffer which stores the intensive quantities of a DOF
+    unsigned intensiveQuantityStorageSlot_(unsigned globalIdx, unsigned timeIdx) const
+    {
+        if (timeIdx == 0 && intensiveQuantityCacheAliased_[globalIdx])
+            return intensiveQuantityCacheSlot_[historySize > 1 ? 1 : 0];
+        return intensiveQuantityCacheSlot_[timeIdx];
+    }
+
+    // make the intensive quantities of time index 0 independent of the ones of time
+    // index 1 by copying them if they are shared
+    void unaliasIntensiveQuantities_(unsigned globalIdx) const
+    {
+        if (!intensiveQuantityCacheAliased_[globalIdx])
+            return;
+
+        unsigned curSlotIdx = intensiveQuantityCacheSlot_[0];
+        unsigned prevSlotIdx = intensiveQuantityCacheSlot_[historySize > 1 ? 1 : 0];
+        intensiveQuantityCacheUpToDate_[curSlotIdx][globalIdx] =
+            intensiveQuantityCacheUpToDate_[prevSlotIdx][globalIdx];
+        if (intensiveQuantityCacheUpToDate_[curSlotIdx][globalIdx])
+            intensiveQuantityCache_[curSlotIdx][globalIdx] = intensiveQuantityCache_[prevSlotIdx][globalIdx];
+        intensiveQuantityCacheAliased_[globalIdx] = 0;
+    }
+
+    // compute the storage term of all DOFs for the current solution and store it as the
+    // one of the previous time level
+    void updatePreviousStorageCache_()
+    {
+        typename ElementChunks<GridView>::Cursor cursor;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            unsigned threadId = ThreadManager::threadId();
+            ElementContext elemCtx(simulator_);
+            EqVector storage;
+            elementChunks_.forEach(cursor, [&](const Element& elem) {
+                elemCtx.updatePrimaryStencil(elem);
+                elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+
+                size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+                    unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                    storage = 0.0;
+                    localResidual(threadId).computeStorage(storage, elemCtx, dofIdx, /*timeIdx=*/0);
+                    storageCache_[/*timeIdx=*/1][globalIdx] = storage;
+                }
+            });
+        }
+
+        previousStorageCached_ = true;
+    }
+
     template <class Context>
     void supplementInitialSolution_(PrimaryVariables&,
                                     const Context&,
@@ -1949,6 +2211,16 @@ protected:
     ElementMapper elementMapper_;
     VertexMapper vertexMapper_;
 
+    // the elements of the grid view for threaded loops
+    ElementChunks<GridView> elementChunks_;
+
+    // the stencils of all elements. only allocated if EnableStencilCache is true
+    std::unique_ptr<StencilCacheType> stencilCache_;
+
+    size_t maxStencilNumDof_ = 0;
+    size_t maxStencilNumPrimaryDof_ = 0;
+    size_t maxStencilNumInteriorFaces_ = 0;
+
     // a vector with all auxiliary equations to be considered
     std::vector<BaseAuxiliaryModule<TypeTag>*> auxEqModules_;
 
@@ -1970,6 +2242,12 @@ protected:
     mutable IntensiveQuantitiesVector intensiveQuantityCache_[historySize];
     // while these are logically bools, concurrent writes to vector<bool> are not thread safe.
     mutable std::vector<unsigned char> intensiveQuantityCacheUpToDate_[historySize];
+    // the buffers above are indexed by slots. the slot of each time index is rotated when
+    // the time level is advanced instead of copying the intensive quantities.
+    mutable std::array<unsigned, historySize> intensiveQuantityCacheSlot_;
+    // for each DOF, whether the intensive quantities for time index 0 are the same as the
+    // ones for time index 1 and are only stored in the slot of the latter
+    mutable std::vector<unsigned char> intensiveQuantityCacheAliased_;
 
     mutable std::array< std::unique_ptr< DiscreteFunction >, historySize > solution_;
 
@@ -1984,6 +2262,10 @@ protected:
     bool enableGridAdaptation_;
     bool enableIntensiveQuantityCache_;
     bool enableStorageCache_;
+    // whether the intensive quantities of the previous time levels are cached
+    bool storeOldIntensiveQuantities_;
+    // whether storageCache_[1] was computed by the last advanceTimeLevel() call
+    bool previousStorageCached_ = false;
     bool enableThermodynamicHints_;
 };
 
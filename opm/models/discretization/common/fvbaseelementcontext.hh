@@ -60,6 +60,9 @@ class FvBaseElementContext
 
     struct DofStore_ {
         IntensiveQuantities intensiveQuantities[timeDiscHistorySize];
+        // if not null, the intensive quantities stored by the model's cache which are
+        // used instead of the ones above
+        const IntensiveQuantities* cachedIntensiveQuantities[timeDiscHistorySize] = {};
         const PrimaryVariables* priVars[timeDiscHistorySize];
         const IntensiveQuantities *thermodynamicHint[timeDiscHistorySize];
     };
@@ -91,13 +94,21 @@ public:
      */
     explicit FvBaseElementContext(const Simulator& simulator)
         : gridView_(simulator.gridView())
-        , stencil_(gridView_, simulator.model().dofMapper() )
+        , stencil_(simulator.model().createStencil())
+        , stencilPtr_(&stencil_)
     {
         // remember the simulator object
         simulatorPtr_ = &simulator;
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
         stashedDofIdx_ = -1;
         focusDofIdx_ = -1;
+        referToCachedIntensiveQuantities_ = false;
+
+        // allocate the storage for the largest stencil of the grid up front, so that
+        // updating the stencil never needs to allocate memory
+        const auto& model = simulator.model();
+        dofVars_.reserve(model.maxStencilNumDof());
+        extensiveQuantities_.reserve(model.maxStencilNumInteriorFaces());
     }
 
     static void *operator new(size_t size)
@@ -134,11 +145,16 @@ public:
         // update the stencil. the center gradients are quite expensive to calculate and
         // most models don't need them, so that we only do this if the model explicitly
         // enables them
-        stencil_.update(elem);
+        if (const auto* stencilCache = model().stencilCache())
+            stencilPtr_ = &stencilCache->get(elem);
+        else {
+            stencil_.update(elem);
+            stencilPtr_ = &stencil_;
+        }
 
         // resize the arrays containing the flux and the volume variables
-        dofVars_.resize(stencil_.numDof());
-        extensiveQuantities_.resize(stencil_.numInteriorFaces());
+        dofVars_.resize(stencilPtr_->numDof());
+        extensiveQuantities_.resize(stencilPtr_->numInteriorFaces());
     }
 
     /*!
@@ -152,10 +168,18 @@ public:
         // remember the current element
         elemPtr_ = &elem;
 
-        // update the finite element geometry
-        stencil_.updatePrimaryTopology(elem);
+        // update the finite element geometry. the stored stencils can only be used if
+        // the primary topology is the same as the full one (e.g. for the vertex-centered
+        // finite volume method).
+        const auto* stencilCache = model().stencilCache();
+        if (stencilCache && stencilCache->get(elem).numDof() == stencilCache->get(elem).numPrimaryDof())
+            stencilPtr_ = &stencilCache->get(elem);
+        else {
+            stencil_.updatePrimaryTopology(elem);
+            stencilPtr_ = &stencil_;
+        }
 
-        dofVars_.resize(stencil_.numPrimaryDof());
+        dofVars_.resize(stencilPtr_->numPrimaryDof());
     }
 
     /*!
@@ -171,6 +195,7 @@ public:
 
         // update the finite element geometry
         stencil_.updateTopology(elem);
+        stencilPtr_ = &stencil_;
     }
 
     /*!
@@ -337,7 +362,7 @@ public:
      *                time discretization.
      */
     const Stencil& stencil(unsigned) const
-    { return stencil_; }
+    { return *stencilPtr_; }
 
     /*!
      * \brief Return the position of a local entities in global coordinates
@@ -348,7 +373,7 @@ public:
      *                time discretization.
      */
     decltype(auto) pos(unsigned dofIdx, unsigned) const
-    { return stencil_.subControlVolume(dofIdx).globalPos(); }
+    { return stencilPtr_->subControlVolume(dofIdx).globalPos(); }
 
     /*!
      * \brief Return the global spatial index for a sub-control volume
@@ -414,7 +439,10 @@ public:
                                    "for the most-recent substep (i.e. time index 0) are available!");
 #endif
 
-        return dofVars_[dofIdx].intensiveQuantities[timeIdx];
+        const auto& dofVars = dofVars_[dofIdx];
+        if (dofVars.cachedIntensiveQuantities[timeIdx])
+            return *dofVars.cachedIntensiveQuantities[timeIdx];
+        return dofVars.intensiveQuantities[timeIdx];
     }
 
     /*!
@@ -436,7 +464,14 @@ public:
     IntensiveQuantities& intensiveQuantities(unsigned dofIdx, unsigned timeIdx)
     {
         assert(dofIdx < numDof(timeIdx));
-        return dofVars_[dofIdx].intensiveQuantities[timeIdx];
+
+        // the object stored by the model's cache must not be modified, so it is copied
+        auto& dofVars = dofVars_[dofIdx];
+        if (dofVars.cachedIntensiveQuantities[timeIdx]) {
+            dofVars.intensiveQuantities[timeIdx] = *dofVars.cachedIntensiveQuantities[timeIdx];
+            dofVars.cachedIntensiveQuantities[timeIdx] = nullptr;
+        }
+        return dofVars.intensiveQuantities[timeIdx];
     }
 
     /*!
@@ -480,7 +515,7 @@ public:
     {
         assert(dofIdx < numDof(/*timeIdx=*/0));
 
-        intensiveQuantitiesStashed_ = dofVars_[dofIdx].intensiveQuantities[/*timeIdx=*/0];
+        intensiveQuantitiesStashed_ = intensiveQuantities(dofIdx, /*timeIdx=*/0);
         priVarsStashed_ = *dofVars_[dofIdx].priVars[/*timeIdx=*/0];
         stashedDofIdx_ = static_cast<int>(dofIdx);
     }
@@ -494,6 +529,7 @@ public:
     {
         dofVars_[dofIdx].priVars[/*timeIdx=*/0] = &priVarsStashed_;
         dofVars_[dofIdx].intensiveQuantities[/*timeIdx=*/0] = intensiveQuantitiesStashed_;
+        dofVars_[dofIdx].cachedIntensiveQuantities[/*timeIdx=*/0] = nullptr;
         stashedDofIdx_ = -1;
     }
 
@@ -530,6 +566,17 @@ public:
     void setEnableStorageCache(bool yesno)
     { enableStorageCache_ = yesno; }
 
+    /*!
+     * \brief Specifies whether the intensive quantities which are cached by the model are
+     *        referred to instead of being copied into the context.
+     *
+     * This avoids copying the intensive quantities if the context is only used to read
+     * them, e.g., for writing output. The referred objects are only valid as long as the
+     * model's cache is not modified.
+     */
+    void setReferToCachedIntensiveQuantities(bool yesno)
+    { referToCachedIntensiveQuantities_ = yesno; }
+
 private:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
@@ -558,8 +605,12 @@ protected:
                 model().thermodynamicHint(globalIdx, timeIdx);
 
             const auto *cachedIntQuants = model().cachedIntensiveQuantities(globalIdx, timeIdx);
+            dofVars_[dofIdx].cachedIntensiveQuantities[timeIdx] = nullptr;
             if (cachedIntQuants) {
-                dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
+                if (referToCachedIntensiveQuantities_)
+                    dofVars_[dofIdx].cachedIntensiveQuantities[timeIdx] = cachedIntQuants;
+                else
+                    dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
             }
             else {
                 updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
@@ -579,6 +630,7 @@ protected:
 #endif
 
         dofVars_[dofIdx].priVars[timeIdx] = &priVars;
+        dofVars_[dofIdx].cachedIntensiveQuantities[timeIdx] = nullptr;
         dofVars_[dofIdx].intensiveQuantities[timeIdx].update(/*context=*/asImp_(), dofIdx, timeIdx);
     }
 
@@ -594,10 +646,13 @@ protected:
     const Element *elemPtr_;
     const GridView gridView_;
     Stencil stencil_;
+    // points to stencil_ or to the stencil of the current element stored by the model
+    const Stencil* stencilPtr_;
 
     int stashedDofIdx_;
     int focusDofIdx_;
     bool enableStorageCache_;
+    bool referToCachedIntensiveQuantities_;
 };
 
 } // namespace Opm
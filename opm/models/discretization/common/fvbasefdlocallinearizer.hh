@@ -41,6 +41,7 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
 #include <limits>
 
 namespace Opm {
@@ -62,6 +63,8 @@ template<class TypeTag, class MyTypeTag>
 struct NumericDifferenceMethod { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct BaseEpsilon { using type = UndefinedProperty; };
+template<class TypeTag, class MyTypeTag>
+struct ReuseUnperturbedVolumeTerms { using type = UndefinedProperty; };
 
 // set the properties to be spliced in
 template<class TypeTag>
@@ -82,6 +85,16 @@ struct Evaluation<TypeTag, TTag::FiniteDifferenceLocalLinearizer>
 template<class TypeTag>
 struct NumericDifferenceMethod<TypeTag, TTag::FiniteDifferenceLocalLinearizer> { static constexpr int value = +1; };
 
+/*!
+ * \brief Specify whether the storage and source terms of the degrees of freedom which
+ *        are not deflected are recomputed for each deflected residual.
+ *
+ * If this is enabled, these terms are taken from the evaluation of the undeflected
+ * residual. This is ignored if the storage term depends on extensive quantities.
+ */
+template<class TypeTag>
+struct ReuseUnperturbedVolumeTerms<TypeTag, TTag::FiniteDifferenceLocalLinearizer> { static constexpr bool value = false; };
+
 //! The base epsilon value for finite difference calculations
 template<class TypeTag>
 struct BaseEpsilon<TypeTag, TTag::FiniteDifferenceLocalLinearizer>
@@ -146,6 +159,7 @@ private:
     using Element = typename GridView::template Codim<0>::Entity;
 
     enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    enum { extensiveStorageTerm = getPropValue<TypeTag, Properties::ExtensiveStorageTerm>() };
 
     // extract local matrices from jacobian matrix for consistency
     using ScalarMatrixBlock = typename GetPropType<TypeTag, Properties::SparseMatrixAdapter>::MatrixBlock;
@@ -172,6 +186,7 @@ public:
 public:
     FvBaseFdLocalLinearizer()
         : internalElemContext_(0)
+        , reuseVolumeTerms_(false)
     { }
 
     ~FvBaseFdLocalLinearizer()
@@ -185,6 +200,10 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, int, NumericDifferenceMethod,
                              "The method used for numeric differentiation (-1: backward "
                              "differences, 0: central differences, 1: forward differences)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, ReuseUnperturbedVolumeTerms,
+                             "Only recompute the storage and source terms of the deflected "
+                             "degree of freedom when numerically differentiating the local "
+                             "residual");
     }
 
     /*!
@@ -200,6 +219,16 @@ public:
         simulatorPtr_ = &simulator;
         delete internalElemContext_;
         internalElemContext_ = new ElementContext(simulator);
+
+        // allocate the storage for the largest stencil of the grid
+        const auto& model = simulator.model();
+        jacobian_.setSize(model.maxStencilNumDof(), model.maxStencilNumPrimaryDof());
+        residual_.reserve(model.maxStencilNumDof());
+        derivResidual_.reserve(model.maxStencilNumDof());
+        deflectedResidual_.reserve(model.maxStencilNumDof());
+
+        reuseVolumeTerms_ =
+            !extensiveStorageTerm && EWOMS_GET_PARAM(TypeTag, bool, ReuseUnperturbedVolumeTerms);
     }
 
     /*!
@@ -243,7 +272,14 @@ public:
         reset_(elemCtx);
 
         // calculate the local residual
-        localResidual_.eval(residual_, elemCtx);
+        if (reuseVolumeTerms_) {
+            // the storage and source terms are kept separately so that the ones of the
+            // DOFs which are not deflected can be used for the deflected residuals
+            localResidual_.evalVolumeTerms(volumeTerms_, elemCtx);
+            localResidual_.evalWithVolumeTerms(residual_, elemCtx, volumeTerms_);
+        }
+        else
+            localResidual_.eval(residual_, elemCtx);
 
         // calculate the local jacobian matrix
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
@@ -347,9 +383,17 @@ protected:
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
 
         residual_.resize(numDof);
-        jacobian_.setSize(numDof, numPrimaryDof);
+
+        // the local Jacobian is only reallocated if the stencil is larger than all
+        // previous ones. only its upper left part is used for smaller stencils
+        if (jacobian_.N() < numDof || jacobian_.M() < numPrimaryDof)
+            jacobian_.setSize(std::max<size_t>(jacobian_.N(), numDof),
+                              std::max<size_t>(jacobian_.M(), numPrimaryDof));
 
         derivResidual_.resize(numDof);
+        deflectedResidual_.resize(numDof);
+        if (reuseVolumeTerms_)
+            volumeTerms_.resize(numDof);
     }
 
     /*!
@@ -432,7 +476,7 @@ protected:
             // calculate the deflected residual
             elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
             elemCtx.updateAllExtensiveQuantities();
-            localResidual_.eval(derivResidual_, elemCtx);
+            evalDeflectedResidual_(derivResidual_, elemCtx, dofIdx);
         }
         else {
             // we are using backward differences, i.e. we don't need
@@ -449,13 +493,13 @@ protected:
             priVars[pvIdx] -= delta + eps;
             delta += eps;
 
-            // calculate the deflected residual again, this time we use the local
-            // residual's internal storage.
+            // calculate the deflected residual again, this time we use a separate
+            // storage.
             elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
             elemCtx.updateAllExtensiveQuantities();
-            localResidual_.eval(elemCtx);
+            evalDeflectedResidual_(deflectedResidual_, elemCtx, dofIdx);
 
-            derivResidual_ -= localResidual_.residual();
+            derivResidual_ -= deflectedResidual_;
         }
         else {
             // we are using forward differences, i.e. we don't need to
@@ -480,6 +524,20 @@ protected:
 #endif
     }
 
+    /*!
+     * \brief Evaluate the local residual after the primary variables of a degree of
+     *        freedom have been deflected.
+     */
+    void evalDeflectedResidual_(LocalEvalBlockVector& residual,
+                                ElementContext& elemCtx,
+                                unsigned dofIdx)
+    {
+        if (reuseVolumeTerms_)
+            localResidual_.evalWithVolumeTerms(residual, elemCtx, volumeTerms_, dofIdx);
+        else
+            localResidual_.eval(residual, elemCtx);
+    }
+
     /*!
      * \brief Updates the current local Jacobian matrix with the partial derivatives of
      *        all equations for primary variable 'pvIdx' at the degree of freedom
@@ -509,9 +567,14 @@ protected:
 
     LocalEvalBlockVector residual_;
     LocalEvalBlockVector derivResidual_;
+    LocalEvalBlockVector deflectedResidual_;
+    // the storage and source terms of the undeflected primary DOFs
+    LocalEvalBlockVector volumeTerms_;
     ScalarLocalBlockMatrix jacobian_;
 
     LocalResidual localResidual_;
+
+    bool reuseVolumeTerms_;
 };
 
 } // namespace Opm
@@ -35,15 +35,21 @@
 #include <opm/common/TimingMacros.hpp>
 #include <opm/grid/utility/SparseTable.hpp>
 
+#include <opm/models/parallel/elementchunks.hh>
 #include <opm/models/parallel/gridcommhandles.hh>
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/simulators/linalg/csrsparsitypattern.hh>
 
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
+#include <dune/grid/common/rangegenerators.hh>
 
+#include <atomic>
+#include <limits>
+#include <numeric>
 #include <type_traits>
 #include <iostream>
 #include <vector>
@@ -84,6 +90,7 @@ class FvBaseLinearizer
     using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
     using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
     using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+    using SparsityPattern = Linear::CsrSparsityPattern;
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
     using Constraints = GetPropType<TypeTag, Properties::Constraints>;
     using Stencil = GetPropType<TypeTag, Properties::Stencil>;
@@ -95,6 +102,7 @@ class FvBaseLinearizer
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
+    using ElementSeed = typename Element::EntitySeed;
 
     using Vector = GlobalEqVector;
 
@@ -240,6 +248,24 @@ public:
             throw NumericalProblem("A process did not succeed in linearizing the system");
     }
 
+    /*!
+     * \brief Evaluate the residual of the spatial domain.
+     *
+     * The local linearizers of this class always compute the residual together with its
+     * derivatives, so the Jacobian matrix is assembled as well.
+     */
+    void linearizeResidualOnly()
+    { linearizeDomain(); }
+
+    /*!
+     * \brief Returns true if linearizeResidualOnly() is cheaper than linearizeDomain().
+     *
+     * This is not the case for this linearizer, so the Newton method does not reuse
+     * the Jacobian matrix.
+     */
+    bool residualOnlyLinearization() const
+    { return false; }
+
     void finalize()
     { jacobian_->finalize(); }
 
@@ -413,38 +439,131 @@ private:
     // Construct the BCRS matrix for the Jacobian of the residual function
     void createMatrix_()
     {
+        OPM_TIMEBLOCK(createMatrix);
         const auto& model = model_();
-        Stencil stencil(gridView_(), model_().dofMapper());
 
         // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
-        sparsityPattern_.clear();
-        sparsityPattern_.resize(model.numTotalDof());
-
-        for (const auto& elem : elements(gridView_())) {
-            stencil.update(elem);
+        // freedom of each primary degree of freedom. each thread records the
+        // connections of the elements it visits in a separate list.
+        using Connection = SparsityPattern::Connection;
+        std::vector<std::vector<Connection>> threadConnections(ThreadManager::maxThreads());
+        typename ElementChunks<GridView>::Cursor cursor;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            unsigned threadId = ThreadManager::threadId();
+            auto& connections = threadConnections[threadId];
+            Stencil stencil = model_().createStencil();
+            model.elementChunks().forEach(cursor, [&](const Element& elem) {
+                stencil.update(elem);
 
-            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
-                unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+                for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                    unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
 
-                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
-                    unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern_[myIdx].insert(neighborIdx);
+                    for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
+                        unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
+                        connections.emplace_back(myIdx, neighborIdx);
+                    }
                 }
-            }
+            });
         }
+        sparsityPattern_.assign(model.numTotalDof(), threadConnections);
+        threadConnections.clear();
 
         // add the additional neighbors and degrees of freedom caused by the auxiliary
         // equations
         size_t numAuxMod = model.numAuxiliaryModules();
-        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern_);
+        if (numAuxMod > 0) {
+            std::vector<std::set<unsigned>> auxNeighbors(model.numTotalDof());
+            for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+                model.auxiliaryModule(auxModIdx)->addNeighbors(auxNeighbors);
+            sparsityPattern_.merge(auxNeighbors);
+        }
 
         // allocate raw matrix
         jacobian_.reset(new SparseMatrixAdapter(simulator_()));
 
         // create matrix structure based on sparsity pattern
         jacobian_->reserve(sparsityPattern_);
+
+        createElementColoring_();
+    }
+
+    // Partition the elements which need to be linearized into colors such that the
+    // elements of a color do not share any primary degree of freedom. Since the
+    // contribution of an element only modifies the residual and the matrix columns of
+    // its primary degrees of freedom, the elements of a color can be added to the
+    // global system concurrently without any locking. For the ECFV discretization,
+    // there is only a single color.
+    void createElementColoring_()
+    {
+        OPM_TIMEBLOCK(createElementColoring);
+        const std::size_t numDof = model_().numTotalDof();
+
+        // the primary degrees of freedom of each element in compressed row format
+        std::vector<ElementSeed> seeds;
+        std::vector<std::size_t> elemDofStart(1, 0);
+        std::vector<unsigned> elemDofs;
+        Stencil stencil = model_().createStencil();
+        for (const auto& elem : elements(gridView_())) {
+            if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            stencil.update(elem);
+            seeds.push_back(elem.seed());
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx)
+                elemDofs.push_back(stencil.globalSpaceIndex(primaryDofIdx));
+            elemDofStart.push_back(elemDofs.size());
+        }
+        const std::size_t numElems = seeds.size();
+
+        // the elements attached to each degree of freedom
+        std::vector<std::size_t> dofElemStart(numDof + 1, 0);
+        for (unsigned dofIdx : elemDofs)
+            ++dofElemStart[dofIdx + 1];
+        std::partial_sum(dofElemStart.begin(), dofElemStart.end(), dofElemStart.begin());
+        std::vector<unsigned> dofElems(elemDofs.size());
+        std::vector<std::size_t> pos(dofElemStart.begin(), dofElemStart.end() - 1);
+        for (std::size_t elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            for (std::size_t i = elemDofStart[elemIdx]; i < elemDofStart[elemIdx + 1]; ++i)
+                dofElems[pos[elemDofs[i]]++] = elemIdx;
+
+        // greedy coloring: each element gets the smallest color which is not used by
+        // any of the elements it shares a degree of freedom with
+        constexpr unsigned noColor = std::numeric_limits<unsigned>::max();
+        std::vector<unsigned> elemColor(numElems, noColor);
+        std::vector<std::size_t> colorBlockedBy;
+        unsigned numColors = 0;
+        for (std::size_t elemIdx = 0; elemIdx < numElems; ++elemIdx) {
+            for (std::size_t i = elemDofStart[elemIdx]; i < elemDofStart[elemIdx + 1]; ++i) {
+                const unsigned dofIdx = elemDofs[i];
+                for (std::size_t j = dofElemStart[dofIdx]; j < dofElemStart[dofIdx + 1]; ++j) {
+                    const unsigned otherColor = elemColor[dofElems[j]];
+                    if (otherColor != noColor)
+                        colorBlockedBy[otherColor] = elemIdx;
+                }
+            }
+
+            unsigned color = 0;
+            while (color < numColors && colorBlockedBy[color] == elemIdx)
+                ++color;
+            if (color == numColors) {
+                ++numColors;
+                colorBlockedBy.push_back(numElems);
+            }
+            elemColor[elemIdx] = color;
+        }
+
+        // sort the elements by color
+        elementColorOffsets_.assign(numColors + 1, 0);
+        for (unsigned color : elemColor)
+            ++elementColorOffsets_[color + 1];
+        std::partial_sum(elementColorOffsets_.begin(), elementColorOffsets_.end(), elementColorOffsets_.begin());
+        coloredElementSeeds_.resize(numElems);
+        std::vector<std::size_t> colorPos(elementColorOffsets_.begin(), elementColorOffsets_.end() - 1);
+        for (std::size_t elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            coloredElementSeeds_[colorPos[elemColor[elemIdx]]++] = seeds[elemIdx];
     }
 
     // reset the global linear system of equations.
@@ -466,17 +585,15 @@ private:
         constraintsMap_.clear();
 
         // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        typename ElementChunks<GridView>::Cursor cursor;
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
         {
             unsigned threadId = ThreadManager::threadId();
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+            model_().elementChunks().forEach(cursor, [&](const Element& elem) {
                 // create an element context (the solution-based quantities are not
                 // available here!)
-                const Element& elem = *elemIt;
                 ElementContext& elemCtx = *elementCtx_[threadId];
                 elemCtx.updateStencil(elem);
 
@@ -497,7 +614,7 @@ private:
                         continue;
                     }
                 }
-            }
+            });
         }
     }
 
@@ -529,6 +646,12 @@ private:
         std::exception_ptr exceptionPtr = nullptr;
 
         // relinearize the elements...
+        if constexpr (std::is_same_v<SubDomainType, FullDomain>) {
+            linearizeColoredElements_();
+            applyConstraintsToLinearization_();
+            return;
+        }
+
         using GridViewType = decltype(domain.view);
         ThreadedEntityIterator<GridViewType, /*codim=*/0> threadedElemIt(domain.view);
 #ifdef _OPENMP
@@ -556,7 +679,7 @@ private:
                     if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
                         continue;
 
-                    linearizeElement_(elem);
+                    linearizeElement_(elem, /*useLock=*/getPropValue<TypeTag, Properties::UseLinearizationLock>());
                 }
             }
             // If an exception occurs in the parallel block, it won't escape the
@@ -586,9 +709,54 @@ private:
     }
 
 
+    // linearize all elements of the process' grid partition color by color. the
+    // elements of a color do not share any primary degree of freedom, so no lock is
+    // required to add their contributions to the global system.
+    void linearizeColoredElements_()
+    {
+        const auto& grid = gridView_().grid();
+
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        std::atomic<bool> failed{false};
+
+        const std::size_t numColors = elementColorOffsets_.empty() ? 0 : elementColorOffsets_.size() - 1;
+        for (std::size_t color = 0; color < numColors; ++color) {
+            const long colorBegin = static_cast<long>(elementColorOffsets_[color]);
+            const long colorEnd = static_cast<long>(elementColorOffsets_[color + 1]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (long idx = colorBegin; idx < colorEnd; ++idx) {
+                // an OpenMP loop cannot be left early, so the remaining iterations
+                // are skipped if an exception occurred
+                if (failed.load(std::memory_order_relaxed))
+                    continue;
+
+                try {
+                    if (idx + 1 < colorEnd) {
+                        const auto& nextElem = grid.entity(coloredElementSeeds_[idx + 1]);
+                        model_().prefetch(nextElem);
+                        problem_().prefetch(nextElem);
+                    }
+
+                    linearizeElement_(grid.entity(coloredElementSeeds_[idx]), /*useLock=*/false);
+                }
+                catch(...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                    failed = true;
+                }
+            }
+
+            if (exceptionPtr)
+                std::rethrow_exception(exceptionPtr);
+        }
+    }
+
     // linearize an element in the interior of the process' grid partition
     template <class ElementType>
-    void linearizeElement_(const ElementType& elem)
+    void linearizeElement_(const ElementType& elem, bool useLock)
     {
         unsigned threadId = ThreadManager::threadId();
 
@@ -599,7 +767,7 @@ private:
         localLinearizer.linearize(*elementCtx, elem);
 
         // update the right hand side and the Jacobian matrix
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        if (useLock)
             globalMatrixMutex_.lock();
 
         size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
@@ -617,7 +785,7 @@ private:
             }
         }
 
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        if (useLock)
             globalMatrixMutex_.unlock();
     }
 
@@ -691,7 +859,12 @@ private:
 
     std::mutex globalMatrixMutex_;
 
-    std::vector<std::set<unsigned int>> sparsityPattern_;
+    SparsityPattern sparsityPattern_;
+
+    // the elements of the process' grid partition sorted by their color. the elements
+    // of color i are located at [elementColorOffsets_[i], elementColorOffsets_[i + 1])
+    std::vector<ElementSeed> coloredElementSeeds_;
+    std::vector<std::size_t> elementColorOffsets_;
 
     struct FullDomain
     {
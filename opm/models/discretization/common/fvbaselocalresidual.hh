@@ -43,6 +43,7 @@
 #include <dune/common/classname.hh>
 
 #include <cmath>
+#include <limits>
 
 namespace Opm {
 /*!
@@ -171,23 +172,74 @@ public:
         // evaluate the boundary conditions
         asImp_().evalBoundary_(residual, elemCtx, /*timeIdx=*/0);
 
-        if (useVolumetricResidual) {
-            // make the residual volume specific (i.e., make it incorrect mass per cubic
-            // meter instead of total mass)
-            size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
-            for (unsigned dofIdx=0; dofIdx < numDof; ++dofIdx) {
-                if (elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0) > 0.0) {
-                    // interior DOF
-                    Scalar dofVolume = elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0);
+        if (useVolumetricResidual)
+            makeVolumeSpecific_(residual, elemCtx);
+    }
+
+    /*!
+     * \brief Compute the storage and source terms of all primary degrees of freedom.
+     *
+     * The result can be passed to evalWithVolumeTerms().
+     *
+     * \param volumeTerms The vector which receives the volume terms of the primary
+     *                    degrees of freedom
+     * \copydetails Doxygen::ecfvElemCtxParam
+     */
+    void evalVolumeTerms(LocalEvalBlockVector& volumeTerms,
+                         ElementContext& elemCtx) const
+    {
+        assert(volumeTerms.size() == elemCtx.numDof(/*timeIdx=*/0));
 
-                    assert(std::isfinite(dofVolume));
-                    Valgrind::CheckDefined(dofVolume);
+        volumeTerms = 0.0;
+        asImp_().evalVolumeTerms_(volumeTerms, elemCtx);
+    }
 
-                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
-                        residual[dofIdx][eqIdx] /= dofVolume;
-                }
+    /*!
+     * \brief Compute the local residual using precomputed storage and source terms.
+     *
+     * The volume terms of all primary degrees of freedom except for the one specified by
+     * focusDofIdx are taken from the result of a previous evalVolumeTerms() call. This
+     * is only correct if the primary variables of these degrees of freedom have not
+     * been changed since then and if the storage term does not depend on extensive
+     * quantities.
+     *
+     * \copydetails Doxygen::residualParam
+     * \copydetails Doxygen::ecfvElemCtxParam
+     * \param volumeTerms The volume terms computed by evalVolumeTerms()
+     * \param focusDofIdx The local index of the degree of freedom for which the volume
+     *                    terms are recomputed. If this is not a primary degree of
+     *                    freedom, all volume terms are taken from volumeTerms
+     */
+    void evalWithVolumeTerms(LocalEvalBlockVector& residual,
+                             ElementContext& elemCtx,
+                             const LocalEvalBlockVector& volumeTerms,
+                             unsigned focusDofIdx = std::numeric_limits<unsigned>::max()) const
+    {
+        assert(!extensiveStorageTerm);
+        assert(residual.size() == elemCtx.numDof(/*timeIdx=*/0));
+
+        residual = 0.0;
+
+        // evaluate the flux terms
+        asImp_().evalFluxes(residual, elemCtx, /*timeIdx=*/0);
+
+        // add the storage and the source terms
+        size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+            if (dofIdx == focusDofIdx) {
+                EvalVector volumeTerm(0.0);
+                asImp_().evalVolumeTerm_(volumeTerm, elemCtx, dofIdx);
+                residual[dofIdx] += volumeTerm;
             }
+            else
+                residual[dofIdx] += volumeTerms[dofIdx];
         }
+
+        // evaluate the boundary conditions
+        asImp_().evalBoundary_(residual, elemCtx, /*timeIdx=*/0);
+
+        if (useVolumetricResidual)
+            makeVolumeSpecific_(residual, elemCtx);
     }
 
     /*!
@@ -490,6 +542,31 @@ protected:
      */
     void evalVolumeTerms_(LocalEvalBlockVector& residual,
                           ElementContext& elemCtx) const
+    {
+        // evaluate the volumetric terms (storage + source terms)
+        size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned dofIdx=0; dofIdx < numPrimaryDof; dofIdx++)
+            asImp_().evalVolumeTerm_(residual[dofIdx], elemCtx, dofIdx);
+
+#if !defined NDEBUG
+        // in debug mode, ensure that the residual is well-defined
+        size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
+        for (unsigned i=0; i < numDof; i++) {
+            for (unsigned j = 0; j < numEq; ++ j) {
+                assert(isfinite(residual[i][j]));
+                Valgrind::CheckDefined(residual[i][j]);
+            }
+        }
+#endif
+    }
+
+    /*!
+     * \brief Add the change in the storage term and the source term of a single
+     *        primary sub-control volume to its local residual.
+     */
+    void evalVolumeTerm_(EvalVector& dofResidual,
+                         ElementContext& elemCtx,
+                         unsigned dofIdx) const
     {
         EvalVector tmp;
         EqVector tmp2;
@@ -498,135 +575,142 @@ protected:
         tmp = 0.0;
         tmp2 = 0.0;
 
-        // evaluate the volumetric terms (storage + source terms)
-        size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
-        for (unsigned dofIdx=0; dofIdx < numPrimaryDof; dofIdx++) {
-            Scalar extrusionFactor =
-                elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
-            Valgrind::CheckDefined(extrusionFactor);
-            assert(isfinite(extrusionFactor));
-            assert(extrusionFactor > 0.0);
-            Scalar scvVolume =
-               elemCtx.stencil(/*timeIdx=*/0).subControlVolume(dofIdx).volume() * extrusionFactor;
-            Valgrind::CheckDefined(scvVolume);
-            assert(isfinite(scvVolume));
-            assert(scvVolume > 0.0);
-
-            // if the model uses extensive quantities in its storage term, and we use
-            // automatic differention and current DOF is also not the one we currently
-            // focus on, the storage term does not need any derivatives!
-            if (!extensiveStorageTerm &&
-                !std::is_same<Scalar, Evaluation>::value &&
-                dofIdx != elemCtx.focusDofIndex())
-            {
-                asImp_().computeStorage(tmp2, elemCtx, dofIdx, /*timeIdx=*/0);
-                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                    tmp[eqIdx] = tmp2[eqIdx];
-            }
-            else
-                asImp_().computeStorage(tmp, elemCtx, dofIdx, /*timeIdx=*/0);
+        Scalar extrusionFactor =
+            elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
+        Valgrind::CheckDefined(extrusionFactor);
+        assert(isfinite(extrusionFactor));
+        assert(extrusionFactor > 0.0);
+        Scalar scvVolume =
+           elemCtx.stencil(/*timeIdx=*/0).subControlVolume(dofIdx).volume() * extrusionFactor;
+        Valgrind::CheckDefined(scvVolume);
+        assert(isfinite(scvVolume));
+        assert(scvVolume > 0.0);
+
+        // if the model uses extensive quantities in its storage term, and we use
+        // automatic differention and current DOF is also not the one we currently
+        // focus on, the storage term does not need any derivatives!
+        if (!extensiveStorageTerm &&
+            !std::is_same<Scalar, Evaluation>::value &&
+            dofIdx != elemCtx.focusDofIndex())
+        {
+            asImp_().computeStorage(tmp2, elemCtx, dofIdx, /*timeIdx=*/0);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                tmp[eqIdx] = tmp2[eqIdx];
+        }
+        else
+            asImp_().computeStorage(tmp, elemCtx, dofIdx, /*timeIdx=*/0);
 
 #ifndef NDEBUG
-            Valgrind::CheckDefined(tmp);
-            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                assert(isfinite(tmp[eqIdx]));
+        Valgrind::CheckDefined(tmp);
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            assert(isfinite(tmp[eqIdx]));
 #endif
 
-            if (elemCtx.enableStorageCache()) {
-                const auto& model = elemCtx.model();
-                unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
-                if (model.newtonMethod().numIterations() == 0 &&
-                    !elemCtx.haveStashedIntensiveQuantities())
-                {
-                    if (!elemCtx.problem().recycleFirstIterationStorage()) {
-                        // we re-calculate the storage term for the solution of the
-                        // previous time step from scratch instead of using the one of
-                        // the first iteration of the current time step.
-                        tmp2 = 0.0;
-                        elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/1);
-                        asImp_().computeStorage(tmp2, elemCtx,  dofIdx, /*timeIdx=*/1);
-                    }
-                    else {
-                        // if the storage term is cached and we're in the first iteration
-                        // of the time step, use the storage term of the first iteration
-                        // as the one as the solution of the last time step (this assumes
-                        // that the initial guess for the solution at the end of the time
-                        // step is the same as the solution at the beginning of the time
-                        // step. This is usually true, but some fancy preprocessing
-                        // scheme might invalidate that assumption.)
-                        for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
-                            tmp2[eqIdx] = Toolbox::value(tmp[eqIdx]);
-                    }
-
-                    Valgrind::CheckDefined(tmp2);
-
-                    model.updateCachedStorage(globalDofIdx, /*timeIdx=*/1, tmp2);
+        if (elemCtx.enableStorageCache()) {
+            const auto& model = elemCtx.model();
+            unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+            if (model.newtonMethod().numIterations() == 0 &&
+                !elemCtx.haveStashedIntensiveQuantities() &&
+                !model.previousStorageCached())
+            {
+                if (!elemCtx.problem().recycleFirstIterationStorage()) {
+                    // we re-calculate the storage term for the solution of the
+                    // previous time step from scratch instead of using the one of
+                    // the first iteration of the current time step.
+                    tmp2 = 0.0;
+                    elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/1);
+                    asImp_().computeStorage(tmp2, elemCtx,  dofIdx, /*timeIdx=*/1);
                 }
                 else {
-                    // if the mass storage at the beginning of the time step is not cached,
-                    // if the storage term is cached and we're not looking at the first
-                    // iteration of the time step, we take the cached data.
-                    tmp2 = model.cachedStorage(globalDofIdx, /*timeIdx=*/1);
-                    Valgrind::CheckDefined(tmp2);
+                    // if the storage term is cached and we're in the first iteration
+                    // of the time step, use the storage term of the first iteration
+                    // as the one as the solution of the last time step (this assumes
+                    // that the initial guess for the solution at the end of the time
+                    // step is the same as the solution at the beginning of the time
+                    // step. This is usually true, but some fancy preprocessing
+                    // scheme might invalidate that assumption.)
+                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+                        tmp2[eqIdx] = Toolbox::value(tmp[eqIdx]);
                 }
+
+                Valgrind::CheckDefined(tmp2);
+
+                model.updateCachedStorage(globalDofIdx, /*timeIdx=*/1, tmp2);
             }
             else {
-                // if the mass storage at the beginning of the time step is not cached,
-                // we re-calculate it from scratch.
-                tmp2 = 0.0;
-                asImp_().computeStorage(tmp2, elemCtx,  dofIdx, /*timeIdx=*/1);
+                // if the storage term is cached and we're not looking at the first
+                // iteration of the time step or the storage term of the previous time
+                // level was computed when the time level was advanced, we take the
+                // cached data.
+                tmp2 = model.cachedStorage(globalDofIdx, /*timeIdx=*/1);
                 Valgrind::CheckDefined(tmp2);
             }
+        }
+        else {
+            // if the mass storage at the beginning of the time step is not cached,
+            // we re-calculate it from scratch.
+            tmp2 = 0.0;
+            asImp_().computeStorage(tmp2, elemCtx,  dofIdx, /*timeIdx=*/1);
+            Valgrind::CheckDefined(tmp2);
+        }
 
-            // Use the implicit Euler time discretization
-            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
-                double dt = elemCtx.simulator().timeStepSize();
-                assert(dt > 0);
-                tmp[eqIdx] -= tmp2[eqIdx];
-                tmp[eqIdx] *= scvVolume / dt;
+        // Use the implicit Euler time discretization
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            double dt = elemCtx.simulator().timeStepSize();
+            assert(dt > 0);
+            tmp[eqIdx] -= tmp2[eqIdx];
+            tmp[eqIdx] *= scvVolume / dt;
 
-                residual[dofIdx][eqIdx] += tmp[eqIdx];
-            }
+            dofResidual[eqIdx] += tmp[eqIdx];
+        }
 
-            Valgrind::CheckDefined(residual[dofIdx]);
+        Valgrind::CheckDefined(dofResidual);
 
-            // deal with the source term
-            asImp_().computeSource(sourceRate, elemCtx, dofIdx, /*timeIdx=*/0);
+        // deal with the source term
+        asImp_().computeSource(sourceRate, elemCtx, dofIdx, /*timeIdx=*/0);
 
-            // if the model uses extensive quantities in its storage term, and we use
-            // automatic differention and current DOF is also not the one we currently
-            // focus on, the storage term does not need any derivatives!
-            if (!extensiveStorageTerm &&
-                !std::is_same<Scalar, Evaluation>::value &&
-                dofIdx != elemCtx.focusDofIndex())
-            {
-                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                    residual[dofIdx][eqIdx] -= scalarValue(sourceRate[eqIdx])*scvVolume;
-            }
-            else {
-                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
-                    sourceRate[eqIdx] *= scvVolume;
-                    residual[dofIdx][eqIdx] -= sourceRate[eqIdx];
-                }
+        // if the model uses extensive quantities in its storage term, and we use
+        // automatic differention and current DOF is also not the one we currently
+        // focus on, the storage term does not need any derivatives!
+        if (!extensiveStorageTerm &&
+            !std::is_same<Scalar, Evaluation>::value &&
+            dofIdx != elemCtx.focusDofIndex())
+        {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                dofResidual[eqIdx] -= scalarValue(sourceRate[eqIdx])*scvVolume;
+        }
+        else {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                sourceRate[eqIdx] *= scvVolume;
+                dofResidual[eqIdx] -= sourceRate[eqIdx];
             }
-
-            Valgrind::CheckDefined(residual[dofIdx]);
         }
 
-#if !defined NDEBUG
-        // in debug mode, ensure that the residual is well-defined
+        Valgrind::CheckDefined(dofResidual);
+    }
+
+
+private:
+    // make the residual volume specific (i.e., make it incorrect mass per cubic meter
+    // instead of total mass)
+    void makeVolumeSpecific_(LocalEvalBlockVector& residual,
+                             const ElementContext& elemCtx) const
+    {
         size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
-        for (unsigned i=0; i < numDof; i++) {
-            for (unsigned j = 0; j < numEq; ++ j) {
-                assert(isfinite(residual[i][j]));
-                Valgrind::CheckDefined(residual[i][j]);
+        for (unsigned dofIdx=0; dofIdx < numDof; ++dofIdx) {
+            if (elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0) > 0.0) {
+                // interior DOF
+                Scalar dofVolume = elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0);
+
+                assert(std::isfinite(dofVolume));
+                Valgrind::CheckDefined(dofVolume);
+
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+                    residual[dofIdx][eqIdx] /= dofVolume;
             }
         }
-#endif
     }
 
-
-private:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
 
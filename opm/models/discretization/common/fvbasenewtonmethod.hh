@@ -33,6 +33,9 @@
 #include <opm/models/nonlinear/newtonmethod.hh>
 #include <opm/models/utils/propertysystem.hh>
 
+#include <algorithm>
+#include <cmath>
+
 namespace Opm {
 
 template <class TypeTag>
@@ -54,6 +57,18 @@ struct FvBaseNewtonMethod { using InheritsFrom = std::tuple<NewtonMethod>; };
 template<class TypeTag, class MyTypeTag>
 struct DiscNewtonMethod { using type = UndefinedProperty; };
 
+/*!
+ * \brief The relative change of the primary variables of a degree of freedom below
+ *        which its intensive quantities are kept after a Newton update.
+ *
+ * The change is measured relative to the primary variables from which the cached
+ * intensive quantities were computed, i.e., small updates accumulate until they exceed
+ * the tolerance. A negative value means that the intensive quantities of all degrees of
+ * freedom are recomputed after each update.
+ */
+template<class TypeTag, class MyTypeTag>
+struct IntensiveQuantityUpdateTolerance { using type = UndefinedProperty; };
+
 // set default values
 template<class TypeTag>
 struct DiscNewtonMethod<TypeTag, TTag::FvBaseNewtonMethod>
@@ -67,6 +82,13 @@ template<class TypeTag>
 struct NewtonConvergenceWriter<TypeTag, TTag::FvBaseNewtonMethod>
 { using type = FvBaseNewtonConvergenceWriter<TypeTag>; };
 
+template<class TypeTag>
+struct IntensiveQuantityUpdateTolerance<TypeTag, TTag::FvBaseNewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = -1.0;
+};
+
 } // namespace Opm::Properties
 
 namespace Opm {
@@ -98,11 +120,60 @@ class FvBaseNewtonMethod : public NewtonMethod<TypeTag>
 public:
     FvBaseNewtonMethod(Simulator& simulator)
         : ParentType(simulator)
-    { }
+    {
+        intensiveQuantityUpdateTolerance_ =
+            EWOMS_GET_PARAM(TypeTag, Scalar, IntensiveQuantityUpdateTolerance);
+    }
+
+    /*!
+     * \brief Register all run-time parameters for the Newton method.
+     */
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, IntensiveQuantityUpdateTolerance,
+                             "The relative change of the primary variables of a degree "
+                             "of freedom since its intensive quantities were computed "
+                             "below which they are not recomputed. A negative value "
+                             "recomputes the intensive quantities of all degrees of freedom");
+    }
 
 protected:
     friend class NewtonMethod<TypeTag>;
 
+    // the update of a subset of the degrees of freedom
+    using ParentType::update_;
+
+    /*!
+     * \brief Called before the Newton method is applied to an non-linear system of
+     *        equations.
+     *
+     * \param u The initial solution
+     */
+    void begin_(const SolutionVector& u)
+    {
+        ParentType::begin_(u);
+
+        // the cached intensive quantities are consistent with the initial solution
+        if (intensiveQuantityUpdateTolerance_ >= 0.0)
+            iqSolution_ = u;
+    }
+
+    /*!
+     * \brief Solve the non-linear problems of the sub-domains of the nonlinear domain
+     *        decomposition.
+     */
+    void solveLocalProblems_()
+    {
+        ParentType::solveLocalProblems_();
+
+        // the sub-domain solver recomputed the intensive quantities of all cells whose
+        // primary variables it has modified
+        if (intensiveQuantityUpdateTolerance_ >= 0.0)
+            iqSolution_ = model_().solution(/*timeIdx=*/0);
+    }
+
     /*!
      * \brief Update the current solution with a delta vector.
      *
@@ -130,13 +201,62 @@ protected:
         // make sure that the intensive quantities get recalculated at the next
         // linearization
         if (model_().storeIntensiveQuantities()) {
-            for (unsigned dofIdx = 0; dofIdx < model_().numGridDof(); ++dofIdx)
+            const bool incremental = intensiveQuantityUpdateTolerance_ >= 0.0;
+            const int numGridDof = static_cast<int>(model_().numGridDof());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (int dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+                if (incremental) {
+                    // keep the cached intensive quantities as long as the primary
+                    // variables did not drift too far from the ones they were computed
+                    // for
+                    if (model_().cachedIntensiveQuantities(dofIdx, /*timeIdx=*/0) &&
+                        !primaryVariablesChanged_(dofIdx,
+                                                  nextSolution[dofIdx],
+                                                  iqSolution_[dofIdx]))
+                        continue;
+
+                    iqSolution_[dofIdx] = nextSolution[dofIdx];
+                }
+
                 model_().setIntensiveQuantitiesCacheEntryValidity(dofIdx,
                                                                   /*timeIdx=*/0,
                                                                   /*valid=*/false);
+            }
         }
     }
 
+    /*!
+     * \brief Returns true if the intensive quantities of a degree of freedom need to
+     *        be recomputed after an update of its primary variables.
+     *
+     * This is the case if the relative change of any primary variable compared to the
+     * values for which the intensive quantities were computed exceeds the tolerance, if
+     * their interpretation changed or if the values of the degree of freedom are
+     * overwritten by a peer process.
+     */
+    bool primaryVariablesChanged_(unsigned dofIdx,
+                                  const PrimaryVariables& nextValue,
+                                  const PrimaryVariables& currentValue) const
+    {
+        if (!model_().isLocalDof(dofIdx))
+            return true;
+
+        // compare the values and the interpretation of the primary variables separately
+        PrimaryVariables tmp(nextValue);
+        for (unsigned pvIdx = 0; pvIdx < tmp.size(); ++pvIdx) {
+            const Scalar delta = std::abs(nextValue[pvIdx] - currentValue[pvIdx]);
+            const Scalar scale = std::max<Scalar>(std::abs(currentValue[pvIdx]), 1.0);
+            if (!(delta <= intensiveQuantityUpdateTolerance_*scale))
+                return true;
+
+            tmp[pvIdx] = currentValue[pvIdx];
+        }
+
+        return !(tmp == currentValue);
+    }
+
     /*!
      * \brief Indicates the beginning of a Newton iteration.
      */
@@ -165,6 +285,12 @@ private:
 
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    Scalar intensiveQuantityUpdateTolerance_;
+
+    // the primary variables from which the cached intensive quantities of the current
+    // solution were computed. only used if intensiveQuantityUpdateTolerance_ >= 0
+    SolutionVector iqSolution_;
 };
 } // namespace Opm
 
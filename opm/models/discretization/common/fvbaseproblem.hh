@@ -75,6 +75,7 @@ private:
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
     using NewtonMethod = GetPropType<TypeTag, Properties::NewtonMethod>;
+    using TimeStepController = GetPropType<TypeTag, Properties::TimeStepController>;
 
     using VertexMapper = GetPropType<TypeTag, Properties::VertexMapper>;
     using ElementMapper = GetPropType<TypeTag, Properties::ElementMapper>;
@@ -120,6 +121,7 @@ public:
         , boundingBoxMin_(std::numeric_limits<double>::max())
         , boundingBoxMax_(-std::numeric_limits<double>::max())
         , simulator_(simulator)
+        , timeStepController_(simulator)
         , defaultVtkWriter_(0)
     {
         // calculate the bounding box of the local partition of the grid view
@@ -181,6 +183,7 @@ public:
                              "Continue with a non-converged solution instead of giving up "
                              "if we encounter a time step size smaller than the minimum time "
                              "step size.");
+        TimeStepController::registerParameters();
     }
 
     /*!
@@ -516,11 +519,13 @@ public:
         std::string errorMessage;
         for (unsigned i = 0; i < maxFails; ++i) {
             bool converged = model().update();
-            if (converged)
+            if (converged) {
+                timeStepController_.timeStepSucceeded();
                 return;
+            }
 
             Scalar dt = simulator().timeStepSize();
-            Scalar nextDt = dt / 2.0;
+            Scalar nextDt = timeStepController_.restartTimeStepSize(dt, i);
             if (dt < minTimeStepSize*(1 + 1e-9)) {
                 if (asImp_().continueOnConvergenceError()) {
                     if (gridView().comm().rank() == 0)
@@ -593,7 +598,7 @@ public:
             return nextTimeStepSize_;
 
         Scalar dtNext = std::min(EWOMS_GET_PARAM(TypeTag, Scalar, MaxTimeStepSize),
-                                 newtonMethod().suggestTimeStepSize(simulator().timeStepSize()));
+                                 timeStepController_.suggestTimeStepSize(simulator().timeStepSize()));
 
         if (dtNext < simulator().maxTimeStepSize()
             && simulator().maxTimeStepSize() < dtNext*2)
@@ -830,6 +835,7 @@ private:
 
     // Attributes required for the actual simulation
     Simulator& simulator_;
+    TimeStepController timeStepController_;
     mutable VtkMultiWriter *defaultVtkWriter_;
 };
 
@@ -195,7 +195,9 @@ struct ThreadsPerProcess { using type = UndefinedProperty; };
 //! use locking to prevent race conditions when linearizing the global system of
 //! equations in multi-threaded mode. (setting this property to true is always save, but
 //! it may slightly deter performance in multi-threaded simlations and some
-//! discretizations do not need this.)
+//! discretizations do not need this.) This only affects the linearization of
+//! sub-domains: the full domain is linearized using an element coloring which does not
+//! require any locking.
 template<class TypeTag, class MyTypeTag>
 struct UseLinearizationLock { using type = UndefinedProperty; };
 
@@ -276,6 +278,14 @@ struct MinTimeStepSize { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct MaxTimeStepDivisions { using type = UndefinedProperty; };
 
+/*!
+ * \brief The class which chooses the time step sizes.
+ *
+ * See FvBaseTimeStepController for the required interface.
+ */
+template<class TypeTag, class MyTypeTag>
+struct TimeStepController { using type = UndefinedProperty; };
+
 /*!
  * \brief Continue with a non-converged solution instead of giving up
  *        if we encounter a time step size smaller than the minimum time
@@ -305,6 +315,16 @@ struct EnableIntensiveQuantityCache { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableStorageCache { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specify whether the stencils of all elements should be computed once and
+ *        stored.
+ *
+ * This avoids recomputing the finite volume geometry whenever an element context is
+ * updated, but comes at the cost of higher memory consumption.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableStencilCache { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify whether to use the already calculated solutions as
  *        starting values of the intensive quantities.
@@ -336,6 +356,14 @@ struct ElementMapper { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct DofMapper { using type = UndefinedProperty; };
 
+/*!
+ * \brief The numbering of the degrees of freedom used by ReorderedMapper.
+ *
+ * Valid values are "natural", "rcm" (reverse Cuthill-McKee) and "morton".
+ */
+template<class TypeTag, class MyTypeTag>
+struct DofOrdering { using type = UndefinedProperty; };
+
 /*!
  * \brief The history size required by the time discretization
  */
@@ -0,0 +1,99 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::FvBaseTimeStepController
+ */
+#ifndef EWOMS_FV_BASE_TIME_STEP_CONTROLLER_HH
+#define EWOMS_FV_BASE_TIME_STEP_CONTROLLER_HH
+
+#include "fvbaseproperties.hh"
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Chooses the time step sizes solely based on the number of Newton iterations.
+ *
+ * This is the default of the TimeStepController property and defines the interface
+ * which FvBaseProblem expects from a time step controller:
+ *
+ * - timeStepSucceeded() is called after the solution of a time step has been found but
+ *   before the problem advances the time level, i.e., the model still provides the
+ *   solution at the beginning of the time step.
+ * - suggestTimeStepSize() returns the size of the next time step given the size of the
+ *   one which was just completed.
+ * - restartTimeStepSize() returns the size of the next attempt after the Newton method
+ *   failed to solve a time step. The result is limited to the minimum time step size
+ *   by the problem.
+ */
+template <class TypeTag>
+class FvBaseTimeStepController
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+
+public:
+    explicit FvBaseTimeStepController(Simulator& simulator)
+        : simulator_(simulator)
+    {}
+
+    /*!
+     * \brief Register all run-time parameters of the time step controller.
+     */
+    static void registerParameters()
+    {}
+
+    /*!
+     * \brief Called after a time step has been solved successfully.
+     */
+    void timeStepSucceeded()
+    {}
+
+    /*!
+     * \brief Returns the size of the next time step.
+     *
+     * \param oldDt The size of the time step which was just completed
+     */
+    Scalar suggestTimeStepSize(Scalar oldDt) const
+    { return simulator_.model().newtonMethod().suggestTimeStepSize(oldDt); }
+
+    /*!
+     * \brief Returns the size of the next attempt to solve a time step after the
+     *        Newton method did not converge.
+     *
+     * \param failedDt The time step size for which the Newton method failed
+     * \param numFailures The number of previous failures of the current time step
+     */
+    Scalar restartTimeStepSize(Scalar failedDt, unsigned /* numFailures */)
+    { return failedDt/2.0; }
+
+protected:
+    Simulator& simulator_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,324 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::PidTimeStepController
+ */
+#ifndef EWOMS_PID_TIME_STEP_CONTROLLER_HH
+#define EWOMS_PID_TIME_STEP_CONTROLLER_HH
+
+#include "fvbaseproperties.hh"
+
+#include <opm/models/utils/parametersystem.hh>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace Opm::Properties {
+
+//! The change of the weighted primary variables per time step which the PID time step
+//! controller aims at
+template<class TypeTag, class MyTypeTag>
+struct TimeStepControlTargetChange { using type = UndefinedProperty; };
+
+//! The maximum factor by which the PID time step controller increases the time step size
+template<class TypeTag, class MyTypeTag>
+struct TimeStepControlMaxGrowth { using type = UndefinedProperty; };
+
+//! The factor by which the PID time step controller reduces the time step size if the
+//! Newton method fails
+template<class TypeTag, class MyTypeTag>
+struct TimeStepControlRestartFactor { using type = UndefinedProperty; };
+
+//! The number of time steps after a failure of the Newton method for which the PID time
+//! step controller does not increase the time step size
+template<class TypeTag, class MyTypeTag>
+struct TimeStepControlGrowthDelay { using type = UndefinedProperty; };
+
+template<class TypeTag>
+struct TimeStepControlTargetChange<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.1;
+};
+
+template<class TypeTag>
+struct TimeStepControlMaxGrowth<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 3.0;
+};
+
+template<class TypeTag>
+struct TimeStepControlRestartFactor<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.5;
+};
+
+template<class TypeTag>
+struct TimeStepControlGrowthDelay<TypeTag, TTag::FvBaseDiscretization> { static constexpr unsigned value = 2; };
+
+} // namespace Opm::Properties
+
+namespace Opm {
+
+namespace detail {
+
+/*!
+ * \brief The part of PidTimeStepController which determines the factors by which the
+ *        time step size is changed from the errors of the successful time steps and the
+ *        failures of the Newton method.
+ */
+template <class Scalar>
+class PidStepSizeControl
+{
+    // the exponents of the proportional, integral and derivative terms
+    static constexpr Scalar kP = 0.075;
+    static constexpr Scalar kI = 0.175;
+    static constexpr Scalar kD = 0.01;
+
+public:
+    // the smallest factor by which the time step size is reduced after a successful
+    // time step
+    static constexpr Scalar minFactor = 0.2;
+
+    PidStepSizeControl(Scalar maxGrowth, Scalar restartFactor, unsigned growthDelay)
+        : maxGrowth_(maxGrowth)
+        , restartFactor_(restartFactor)
+        , growthDelay_(growthDelay)
+    { errors_.fill(1.0); }
+
+    /*!
+     * \brief Records the error of a successful time step.
+     *
+     * The error is the change of the solution divided by the targeted change.
+     */
+    void timeStepSucceeded(Scalar error)
+    {
+        errors_[0] = errors_[1];
+        errors_[1] = errors_[2];
+        errors_[2] = std::max(error, Scalar(1e-10));
+        numErrors_ = std::min(numErrors_ + 1, 3u);
+
+        if (stepsSinceFailure_ < std::numeric_limits<unsigned>::max())
+            ++stepsSinceFailure_;
+    }
+
+    /*!
+     * \brief Returns the factor by which the size of the next time step should differ
+     *        from the one of the last successful time step.
+     */
+    Scalar growthFactor() const
+    {
+        Scalar factor = 1.0;
+        if (numErrors_ > 0) {
+            const Scalar e2 = errors_[2];
+            const Scalar e1 = numErrors_ > 1 ? errors_[1] : e2;
+            const Scalar e0 = numErrors_ > 2 ? errors_[0] : e1;
+
+            if (e2 > 1.0)
+                factor = 1.0/e2;
+            else
+                factor =
+                    std::pow(e1/e2, kP)
+                    * std::pow(1.0/e2, kI)
+                    * std::pow(e1*e1/(e2*e0), kD);
+        }
+
+        factor = std::clamp(factor, minFactor, maxGrowth_);
+        if (stepsSinceFailure_ <= growthDelay_)
+            factor = std::min(factor, Scalar(1.0));
+
+        return factor;
+    }
+
+    /*!
+     * \brief Records a failure of the Newton method and returns the factor by which the
+     *        size of the failed attempt is reduced.
+     *
+     * The size of the failed attempt already includes the reductions of the previous
+     * attempts of the same time step, so the factor does not depend on their number.
+     *
+     * \param numFailures The number of previous failures of the same time step
+     */
+    Scalar timeStepFailed(unsigned numFailures)
+    {
+        unsigned numReductions = 1;
+        if (numFailures == 0 && stepsSinceFailure_ <= growthDelay_)
+            // the last failure was only a few time steps ago, so the previous reduction
+            // was not sufficient
+            ++numReductions;
+        stepsSinceFailure_ = 0;
+
+        return std::pow(restartFactor_, Scalar(numReductions));
+    }
+
+private:
+    Scalar maxGrowth_;
+    Scalar restartFactor_;
+    unsigned growthDelay_;
+
+    // the errors of the last three successful time steps, the most recent one last
+    std::array<Scalar, 3> errors_;
+    unsigned numErrors_ = 0;
+    unsigned stepsSinceFailure_ = std::numeric_limits<unsigned>::max();
+};
+
+} // namespace detail
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Chooses the time step sizes based on the change of the solution.
+ *
+ * The error of a time step is the maximum change of any primary variable weighted by
+ * Model::primaryVarWeight() divided by the TimeStepControlTargetChange parameter. By
+ * default, this is the relative change of pressures and the absolute change of
+ * saturations and mole fractions. Degrees of freedom which switched their primary
+ * variables are ignored. If the error exceeded 1, the time step size is
+ * reduced proportionally. Otherwise, the next time step size is chosen using the PID
+ * controller of Valli et al. (2002) based on the errors of the last three time steps.
+ * The result is never larger than the size suggested by the Newton method, i.e.,
+ * time steps which were hard to solve are not enlarged.
+ *
+ * If the Newton method fails, the time step size is multiplied by
+ * TimeStepControlRestartFactor for each attempt. The first attempt is reduced once more
+ * if the previous failure was only a few time steps ago. After a failure, the time step size is not increased for
+ * TimeStepControlGrowthDelay time steps.
+ *
+ * To use this controller, set the TimeStepController property:
+ * \code
+ * template<class TypeTag>
+ * struct TimeStepController<TypeTag, TTag::YourTypeTag>
+ * { using type = Opm::PidTimeStepController<TypeTag>; };
+ * \endcode
+ */
+template <class TypeTag>
+class PidTimeStepController
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
+
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+public:
+    explicit PidTimeStepController(Simulator& simulator)
+        : simulator_(simulator)
+        , targetChange_(EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlTargetChange))
+        , control_(EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth),
+                   EWOMS_GET_PARAM(TypeTag, Scalar, TimeStepControlRestartFactor),
+                   EWOMS_GET_PARAM(TypeTag, unsigned, TimeStepControlGrowthDelay))
+    {}
+
+    /*!
+     * \copydoc FvBaseTimeStepController::registerParameters
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlTargetChange,
+                             "The change of the weighted primary variables per time "
+                             "step which the time step controller aims at");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlMaxGrowth,
+                             "The maximum factor by which the time step size is increased");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, TimeStepControlRestartFactor,
+                             "The factor by which the time step size is reduced if the "
+                             "Newton method fails");
+        EWOMS_REGISTER_PARAM(TypeTag, unsigned, TimeStepControlGrowthDelay,
+                             "The number of time steps after a failure of the Newton "
+                             "method for which the time step size is not increased");
+    }
+
+    /*!
+     * \copydoc FvBaseTimeStepController::timeStepSucceeded
+     */
+    void timeStepSucceeded()
+    { control_.timeStepSucceeded(solutionChange_()/targetChange_); }
+
+    /*!
+     * \copydoc FvBaseTimeStepController::suggestTimeStepSize
+     */
+    Scalar suggestTimeStepSize(Scalar oldDt) const
+    {
+        const Scalar newtonDt = simulator_.model().newtonMethod().suggestTimeStepSize(oldDt);
+        const Scalar nextDt = std::min(oldDt*control_.growthFactor(), newtonDt);
+        return std::max(nextDt, simulator_.problem().minTimeStepSize());
+    }
+
+    /*!
+     * \copydoc FvBaseTimeStepController::restartTimeStepSize
+     */
+    Scalar restartTimeStepSize(Scalar failedDt, unsigned numFailures)
+    { return failedDt*control_.timeStepFailed(numFailures); }
+
+protected:
+    /*!
+     * \brief Returns the maximum weighted change of the primary variables over the
+     *        current time step.
+     *
+     * Degrees of freedom whose primary variables changed their meaning, e.g., from the
+     * gas saturation to the dissolved gas factor, are not considered because the
+     * values before and after the switch cannot be compared.
+     */
+    Scalar solutionChange_() const
+    {
+        const auto& model = simulator_.model();
+        const auto& curSol = model.solution(/*timeIdx=*/0);
+        const auto& prevSol = model.solution(/*timeIdx=*/1);
+
+        Scalar maxChange = 0.0;
+        const unsigned numGridDof = static_cast<unsigned>(model.numGridDof());
+        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            if (!model.isLocalDof(dofIdx))
+                continue;
+
+            // the primary variables compare equal to the previous ones after copying
+            // the values only if their interpretation is the same
+            PrimaryVariables tmp(curSol[dofIdx]);
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                tmp[pvIdx] = prevSol[dofIdx][pvIdx];
+            if (!(tmp == prevSol[dofIdx]))
+                continue;
+
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                const Scalar delta = std::abs(curSol[dofIdx][pvIdx] - prevSol[dofIdx][pvIdx]);
+                maxChange = std::max(maxChange, delta*model.primaryVarWeight(dofIdx, pvIdx));
+            }
+        }
+
+        return simulator_.gridView().comm().max(maxChange);
+    }
+
+    Simulator& simulator_;
+
+    Scalar targetChange_;
+    detail::PidStepSizeControl<Scalar> control_;
+};
+
+} // namespace Opm
+
+#endif
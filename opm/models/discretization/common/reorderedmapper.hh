@@ -0,0 +1,363 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::ReorderedMapper
+ */
+#ifndef EWOMS_REORDERED_MAPPER_HH
+#define EWOMS_REORDERED_MAPPER_HH
+
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <dune/common/version.hh>
+#include <dune/geometry/type.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Computes the reverse Cuthill-McKee ordering of a graph.
+ *
+ * Each connected component of the graph is started at a vertex of minimum degree.
+ *
+ * \param adjacency The neighbors of each vertex of the graph
+ * \return The vertices of the graph in the order in which they ought to be numbered
+ */
+inline std::vector<unsigned> reverseCuthillMcKeeOrder(const std::vector<std::vector<unsigned>>& adjacency)
+{
+    const std::size_t numVertices = adjacency.size();
+    const auto byDegree = [&adjacency](unsigned a, unsigned b)
+    { return adjacency[a].size() < adjacency[b].size(); };
+
+    std::vector<unsigned> startCandidates(numVertices);
+    std::iota(startCandidates.begin(), startCandidates.end(), 0);
+    std::stable_sort(startCandidates.begin(), startCandidates.end(), byDegree);
+
+    std::vector<unsigned> order;
+    order.reserve(numVertices);
+    std::vector<bool> visited(numVertices, false);
+    std::vector<unsigned> newNeighbors;
+    for (unsigned startIdx : startCandidates) {
+        if (visited[startIdx])
+            continue;
+
+        // breadth first search. order doubles as the queue of the search
+        visited[startIdx] = true;
+        std::size_t head = order.size();
+        order.push_back(startIdx);
+        while (head < order.size()) {
+            const unsigned vertexIdx = order[head++];
+            newNeighbors.clear();
+            for (unsigned neighborIdx : adjacency[vertexIdx]) {
+                if (!visited[neighborIdx]) {
+                    visited[neighborIdx] = true;
+                    newNeighbors.push_back(neighborIdx);
+                }
+            }
+            std::stable_sort(newNeighbors.begin(), newNeighbors.end(), byDegree);
+            order.insert(order.end(), newNeighbors.begin(), newNeighbors.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+/*!
+ * \brief Computes the order of a set of points along a Morton (Z-order) space filling
+ *        curve.
+ *
+ * \param positions The coordinates of the points
+ * \return The points in the order in which they ought to be numbered
+ */
+template <class Position>
+std::vector<unsigned> mortonOrder(const std::vector<Position>& positions)
+{
+    constexpr int dim = Position::dimension;
+    constexpr int bitsPerDim = 63/dim;
+    const std::size_t numPoints = positions.size();
+
+    std::vector<unsigned> order(numPoints);
+    std::iota(order.begin(), order.end(), 0);
+    if (numPoints == 0)
+        return order;
+
+    Position lower = positions[0];
+    Position upper = positions[0];
+    for (const auto& pos : positions) {
+        for (int dimIdx = 0; dimIdx < dim; ++dimIdx) {
+            lower[dimIdx] = std::min(lower[dimIdx], pos[dimIdx]);
+            upper[dimIdx] = std::max(upper[dimIdx], pos[dimIdx]);
+        }
+    }
+
+    const std::uint64_t maxCoord = (std::uint64_t(1) << bitsPerDim) - 1;
+    std::vector<std::uint64_t> keys(numPoints, 0);
+    for (std::size_t pointIdx = 0; pointIdx < numPoints; ++pointIdx) {
+        std::uint64_t quantized[dim];
+        for (int dimIdx = 0; dimIdx < dim; ++dimIdx) {
+            const auto extent = upper[dimIdx] - lower[dimIdx];
+            const double relPos = (extent > 0) ? (positions[pointIdx][dimIdx] - lower[dimIdx])/extent : 0.0;
+            quantized[dimIdx] = static_cast<std::uint64_t>(relPos*static_cast<double>(maxCoord));
+        }
+
+        // interleave the bits of the quantized coordinates
+        std::uint64_t key = 0;
+        for (int bitIdx = bitsPerDim - 1; bitIdx >= 0; --bitIdx)
+            for (int dimIdx = 0; dimIdx < dim; ++dimIdx)
+                key = (key << 1) | ((quantized[dimIdx] >> bitIdx) & 1);
+        keys[pointIdx] = key;
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+                     [&keys](unsigned a, unsigned b)
+                     { return keys[a] < keys[b]; });
+    return order;
+}
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief A mapper for the elements or the vertices of a grid view which numbers the
+ *        entities in an order that improves memory locality.
+ *
+ * On unstructured or load-balanced grids, the order in which the grid iterates over
+ * its entities tends to scatter the neighbors of an entity in memory. Since all
+ * global arrays of the discretization (solutions, caches, the Jacobian matrix, etc.)
+ * are indexed by the DOF mapper, using this mapper as ElementMapper or VertexMapper
+ * renumbers all of them at once. The ordering is selected at runtime using the
+ * DofOrdering parameter:
+ *
+ * - "natural": the order in which the grid view iterates over the entities
+ * - "rcm": reverse Cuthill-McKee ordering of the connectivity graph
+ * - "morton": order along a Morton space filling curve through the entity centers
+ *
+ * The ordering only depends on the grid view, so all instances of the mapper agree
+ * on it. Use restoreNaturalOrder() to convert a buffer indexed by this mapper to the
+ * order expected by the output writers.
+ */
+template <class TypeTag>
+class ReorderedMapper
+{
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using BaseMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using Element = typename GridView::template Codim<0>::Entity;
+    using GlobalPosition = typename Element::Geometry::GlobalCoordinate;
+
+    enum { dim = GridView::dimension };
+
+public:
+    using Index = typename BaseMapper::Index;
+
+    ReorderedMapper(const GridView& gridView, const Dune::MCMGLayout& layout)
+        : gridView_(gridView)
+        , baseMapper_(gridView, layout)
+        , isVertexMapper_(layout(Dune::GeometryTypes::vertex, dim) > 0)
+    { computeOrdering_(); }
+
+    /*!
+     * \brief Returns the index of an entity.
+     */
+    template <class Entity>
+    Index index(const Entity& entity) const
+    { return newIndex_[baseMapper_.index(entity)]; }
+
+    /*!
+     * \brief Returns the index of a sub-entity of an element.
+     */
+    Index subIndex(const Element& element, int i, unsigned codim) const
+    { return newIndex_[baseMapper_.subIndex(element, i, codim)]; }
+
+    /*!
+     * \brief Returns the index of an entity if it is mapped.
+     */
+    template <class Entity>
+    bool contains(const Entity& entity, Index& result) const
+    {
+        if (!baseMapper_.contains(entity, result))
+            return false;
+
+        result = newIndex_[result];
+        return true;
+    }
+
+    /*!
+     * \brief Returns the number of mapped entities.
+     */
+    auto size() const
+    { return baseMapper_.size(); }
+
+    /*!
+     * \brief Returns the index an entity would get from the grid's natural ordering.
+     */
+    Index naturalIndex(Index idx) const
+    { return naturalIndex_[idx]; }
+
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
+    /*!
+     * \brief Recompute the mapping after the grid view was modified.
+     */
+    void update(const GridView& gridView)
+    {
+        gridView_ = gridView;
+        baseMapper_.update(gridView);
+        computeOrdering_();
+    }
+#else
+    /*!
+     * \brief Recompute the mapping after the grid view was modified.
+     */
+    void update()
+    {
+        baseMapper_.update();
+        computeOrdering_();
+    }
+#endif
+
+private:
+    void computeOrdering_()
+    {
+        const std::string ordering = EWOMS_GET_PARAM(TypeTag, std::string, DofOrdering);
+        const std::size_t numEntities = baseMapper_.size();
+
+        std::vector<unsigned> order;
+        if (ordering == "natural") {
+            order.resize(numEntities);
+            std::iota(order.begin(), order.end(), 0);
+        }
+        else if (ordering == "rcm")
+            order = reverseCuthillMcKeeOrder(adjacency_());
+        else if (ordering == "morton")
+            order = mortonOrder(positions_());
+        else
+            throw std::invalid_argument("Unknown DOF ordering '" + ordering + "'. "
+                                        "Valid orderings are 'natural', 'rcm' and 'morton'.");
+
+        naturalIndex_.assign(order.begin(), order.end());
+        newIndex_.resize(numEntities);
+        for (std::size_t newIdx = 0; newIdx < numEntities; ++newIdx)
+            newIndex_[naturalIndex_[newIdx]] = static_cast<Index>(newIdx);
+    }
+
+    // the connectivity graph of the mapped entities in their natural numbering
+    std::vector<std::vector<unsigned>> adjacency_() const
+    {
+        std::vector<std::vector<unsigned>> adjacency(baseMapper_.size());
+        for (const auto& elem : elements(gridView_)) {
+            if (isVertexMapper_) {
+                // all vertices of an element are coupled
+                const unsigned numVertices = elem.subEntities(dim);
+                for (unsigned i = 0; i < numVertices; ++i) {
+                    const unsigned globalI = static_cast<unsigned>(baseMapper_.subIndex(elem, i, dim));
+                    for (unsigned j = 0; j < numVertices; ++j)
+                        if (i != j)
+                            adjacency[globalI].push_back(static_cast<unsigned>(baseMapper_.subIndex(elem, j, dim)));
+                }
+            }
+            else {
+                const unsigned elemIdx = static_cast<unsigned>(baseMapper_.index(elem));
+                for (const auto& intersection : intersections(gridView_, elem))
+                    if (intersection.neighbor())
+                        adjacency[elemIdx].push_back(static_cast<unsigned>(baseMapper_.index(intersection.outside())));
+            }
+        }
+
+        for (auto& neighbors : adjacency) {
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        }
+
+        return adjacency;
+    }
+
+    // the positions of the mapped entities in their natural numbering
+    std::vector<GlobalPosition> positions_() const
+    {
+        std::vector<GlobalPosition> positions(baseMapper_.size());
+        for (const auto& elem : elements(gridView_)) {
+            const auto& geometry = elem.geometry();
+            if (isVertexMapper_) {
+                const unsigned numVertices = elem.subEntities(dim);
+                for (unsigned i = 0; i < numVertices; ++i)
+                    positions[baseMapper_.subIndex(elem, i, dim)] = geometry.corner(i);
+            }
+            else
+                positions[baseMapper_.index(elem)] = geometry.center();
+        }
+
+        return positions;
+    }
+
+    GridView gridView_;
+    BaseMapper baseMapper_;
+    bool isVertexMapper_;
+
+    std::vector<Index> newIndex_;
+    std::vector<Index> naturalIndex_;
+};
+
+/*!
+ * \brief Returns the index which an entity mapped to a given index would get from the
+ *        grid view's natural numbering.
+ *
+ * This is the identity for all mappers except ReorderedMapper.
+ */
+template <class Mapper>
+unsigned naturalIndex(const Mapper&, unsigned idx)
+{ return idx; }
+
+template <class TypeTag>
+unsigned naturalIndex(const ReorderedMapper<TypeTag>& mapper, unsigned idx)
+{ return static_cast<unsigned>(mapper.naturalIndex(idx)); }
+
+/*!
+ * \brief Brings a buffer which is indexed by a mapper into the order of the grid
+ *        view's natural numbering.
+ *
+ * This is a no-op for all mappers except ReorderedMapper.
+ */
+template <class Mapper, class Buffer>
+void restoreNaturalOrder(const Mapper&, Buffer&)
+{ }
+
+template <class TypeTag, class Buffer>
+void restoreNaturalOrder(const ReorderedMapper<TypeTag>& mapper, Buffer& buffer)
+{
+    const Buffer tmp(buffer);
+    for (std::size_t idx = 0; idx < tmp.size(); ++idx)
+        buffer[mapper.naturalIndex(idx)] = tmp[idx];
+}
+
+} // namespace Opm
+
+#endif
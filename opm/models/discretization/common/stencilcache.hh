@@ -0,0 +1,121 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::StencilCache
+ */
+#ifndef EWOMS_STENCIL_CACHE_HH
+#define EWOMS_STENCIL_CACHE_HH
+
+#include <opm/models/utils/alignedallocator.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Stores the fully updated stencil of each element of a grid view.
+ *
+ * The finite volume geometry of an element does not change as long as the grid is not
+ * modified, so the element contexts can use the stencils stored by this object instead
+ * of recomputing them for every element they visit. This trades memory for CPU time,
+ * which pays off in particular for the vertex-centered finite volume method.
+ *
+ * The stencils are created using the factory of the discretization, see
+ * FvBaseDiscretization::createStencil(). They are updated in place and never moved
+ * afterwards because they may contain pointers to their own members and to the element
+ * which was passed to their update() method. For the latter reason, the elements are
+ * stored as well. The object must be rebuilt using update() whenever the grid is
+ * modified.
+ */
+template <class GridView, class Stencil, class ElementMapper>
+class StencilCache
+{
+    using Element = typename GridView::template Codim<0>::Entity;
+
+public:
+    using StencilFactory = std::function<Stencil()>;
+
+    StencilCache(const GridView& gridView,
+                 const ElementMapper& elementMapper,
+                 StencilFactory createStencil)
+        : gridView_(gridView)
+        , elementMapper_(elementMapper)
+        , createStencil_(std::move(createStencil))
+    { update(); }
+
+    // the stencils refer to the grid view of this object
+    StencilCache(const StencilCache&) = delete;
+
+    /*!
+     * \brief Recompute the stencils of all elements.
+     *
+     * ATTENTION: This method must be called in a sequential context!
+     */
+    void update()
+    {
+        const std::size_t numElements = gridView_.size(/*codim=*/0);
+
+        // make sure that the stencils will not be moved while they are emplaced
+        stencils_.clear();
+        elements_.clear();
+        stencils_.reserve(numElements);
+        elements_.reserve(numElements);
+        elemToStencil_.resize(elementMapper_.size());
+
+        for (const auto& elem : elements(gridView_)) {
+            elemToStencil_[elementMapper_.index(elem)] = static_cast<unsigned>(stencils_.size());
+            elements_.push_back(elem);
+            stencils_.push_back(createStencil_());
+            stencils_.back().update(elements_.back());
+        }
+        assert(stencils_.size() == numElements);
+    }
+
+    /*!
+     * \brief Returns the stencil of an element.
+     */
+    const Stencil& get(const Element& elem) const
+    { return stencils_[elemToStencil_[elementMapper_.index(elem)]]; }
+
+private:
+    GridView gridView_;
+    const ElementMapper& elementMapper_;
+    StencilFactory createStencil_;
+
+    std::vector<Stencil, aligned_allocator<Stencil, 64>> stencils_;
+    std::vector<Element> elements_;
+    std::vector<unsigned> elemToStencil_;
+};
+
+} // namespace Opm
+
+#endif
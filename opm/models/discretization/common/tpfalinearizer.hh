@@ -40,13 +40,20 @@
 #include <opm/input/eclipse/Schedule/BCProp.hpp>
 
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/discretization/common/reorderedmapper.hh>
+#include <opm/models/parallel/costbalancedloopscheduler.hh>
+#include <opm/simulators/linalg/csrsparsitypattern.hh>
 
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
+#include <array>
 #include <type_traits>
 #include <iostream>
+#include <limits>
+#include <string>
 #include <vector>
 #include <thread>
 #include <set>
@@ -60,6 +67,20 @@ namespace Opm::Properties {
         using type = bool;
         static constexpr type value = false;
     };
+
+    template<class TypeTag, class MyTypeTag>
+    struct UseFaceBasedAssembly {
+        using type = bool;
+        static constexpr type value = false;
+    };
+
+    // the number of faces which are processed at once by the face based assembly if
+    // the local residual provides a batched flux kernel. 1 disables the batched kernel.
+    template<class TypeTag, class MyTypeTag>
+    struct FaceFluxBatchSize {
+        using type = unsigned;
+        static constexpr type value = 4;
+    };
 }
 
 namespace Opm {
@@ -68,6 +89,41 @@ namespace Opm {
 template<class TypeTag>
 class EcfvDiscretization;
 
+namespace detail {
+// find out whether a local residual provides a face based flux kernel which can be
+// used for the enabled modules
+template <class LocalResidual, class = void>
+struct HasFaceFluxKernel : public std::false_type
+{};
+
+template <class LocalResidual>
+struct HasFaceFluxKernel<LocalResidual, std::void_t<typename LocalResidual::FaceRateVector>>
+    : public std::integral_constant<bool, LocalResidual::enableFaceFluxKernel>
+{};
+
+// find out whether a local residual provides a flux kernel which processes a batch of
+// faces at once
+template <class LocalResidual, class = void>
+struct HasBatchedFaceFluxKernel : public std::false_type
+{};
+
+template <class LocalResidual>
+struct HasBatchedFaceFluxKernel<LocalResidual, std::void_t<typename LocalResidual::FaceBatchLane>>
+    : public HasFaceFluxKernel<LocalResidual>
+{};
+
+// find out whether a local residual can compute fluxes without derivatives for the
+// enabled modules
+template <class LocalResidual, class = void>
+struct HasScalarFluxKernel : public std::false_type
+{};
+
+template <class LocalResidual>
+struct HasScalarFluxKernel<LocalResidual, std::void_t<typename LocalResidual::ScalarRateVector>>
+    : public std::integral_constant<bool, LocalResidual::enableScalarFluxKernel>
+{};
+} // namespace detail
+
 /*!
  * \ingroup FiniteVolumeDiscretizations
  *
@@ -91,6 +147,7 @@ class TpfaLinearizer
     using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
     using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
     using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+    using SparsityPattern = Linear::CsrSparsityPattern;
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
     using Constraints = GetPropType<TypeTag, Properties::Constraints>;
     using Stencil = GetPropType<TypeTag, Properties::Stencil>;
@@ -113,6 +170,12 @@ class TpfaLinearizer
     static const bool linearizeNonLocalElements = getPropValue<TypeTag, Properties::LinearizeNonLocalElements>();
     static const bool enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>();
     static const bool enableDiffusion = getPropValue<TypeTag, Properties::EnableDiffusion>();
+    static const bool enableDispersion = getPropValue<TypeTag, Properties::EnableDispersion>();
+    static constexpr bool faceFluxKernelAvailable = detail::HasFaceFluxKernel<LocalResidual>::value;
+    static constexpr bool scalarFluxKernelAvailable = detail::HasScalarFluxKernel<LocalResidual>::value;
+    static constexpr unsigned faceFluxBatchSize = getPropValue<TypeTag, Properties::FaceFluxBatchSize>();
+    static constexpr bool batchedFaceFluxKernelAvailable =
+        detail::HasBatchedFaceFluxKernel<LocalResidual>::value && faceFluxBatchSize > 1;
     // copying the linearizer is not a good idea
     TpfaLinearizer(const TpfaLinearizer&);
 //! \endcond
@@ -123,6 +186,7 @@ public:
     {
         simulatorPtr_ = 0;
         separateSparseSourceTerms_ = EWOMS_GET_PARAM(TypeTag, bool, SeparateSparseSourceTerms);
+        useFaceBasedAssembly_ = faceFluxKernelAvailable && EWOMS_GET_PARAM(TypeTag, bool, UseFaceBasedAssembly);
     }
 
     ~TpfaLinearizer()
@@ -136,6 +200,9 @@ public:
     {
         EWOMS_REGISTER_PARAM(TypeTag, bool, SeparateSparseSourceTerms,
                              "Treat well source terms all in one go, instead of on a cell by cell basis.");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, UseFaceBasedAssembly,
+                             "Evaluate the flux over each interior face only once and add it to both adjacent cells. "
+                             "This is ignored if the local residual does not provide a face based flux kernel.");
     }
 
     /*!
@@ -248,9 +315,57 @@ public:
         linearize_(domain);
     }
 
+    /*!
+     * \brief Evaluate the residual of the spatial domain without the Jacobian.
+     *
+     * This is considerably cheaper than linearizeDomain() and intended for cases where
+     * only the residual is of interest, e.g., line searches or convergence checks.
+     * The Jacobian matrix is not modified, i.e., it still corresponds to the last
+     * linearization, and no flows or flores are recorded for the output.
+     */
+    void linearizeResidualOnly()
+    { linearizeResidualOnly(fullDomain_); }
+
+    /*!
+     * \brief Evaluate the residual of a part of the spatial domain without the
+     *        Jacobian.
+     */
+    template <class SubDomainType>
+    void linearizeResidualOnly(const SubDomainType& domain)
+    {
+        OPM_TIMEBLOCK(linearizeResidualOnly);
+        if (!jacobian_)
+            initFirstIteration_();
+
+        if (domain.cells.size() == model_().numTotalDof()) {
+            residual_ = 0.0;
+        } else {
+            for (int globI : domain.cells)
+                residual_[globI] = 0.0;
+        }
+
+        evaluateResidual_(domain);
+    }
+
+    /*!
+     * \brief Returns true if linearizeResidualOnly() is cheaper than linearizeDomain().
+     */
+    bool residualOnlyLinearization() const
+    { return true; }
+
     void finalize()
     { jacobian_->finalize(); }
 
+    /*!
+     * \brief Returns true if sub-domains which do not have any cells in common may be
+     *        linearized concurrently by linearizeDomain().
+     *
+     * This is not the case if the sparse source terms are treated separately because
+     * the well model adds them for all cells at once.
+     */
+    bool concurrentDomainLinearization() const
+    { return !separateSparseSourceTerms_; }
+
     /*!
      * \brief Linearize the part of the non-linear system of equations that is associated
      *        with the spatial domain.
@@ -315,7 +430,7 @@ public:
      * (This object is only non-empty if the FLOWS keyword is true.)
      */
     const auto& getFlowsInfo() const{
-
+        updateFlowsInfo();
         return flowsInfo_;
     }
 
@@ -325,10 +440,73 @@ public:
      * (This object is only non-empty if the FLORES keyword is true.)
      */
     const auto& getFloresInfo() const{
-
+        updateFlowsInfo();
         return floresInfo_;
     }
 
+    /*!
+     * \brief Compute the flows and flores from the intensive quantities which are
+     *        currently cached by the model.
+     *
+     * These quantities are only required for the output, so they are not recorded by
+     * the Newton iterations but computed on demand in a separate pass. Note that the
+     * result corresponds to the state for which the intensive quantities were last
+     * updated, i.e., usually the solution after the last Newton update, not the
+     * state at which the Jacobian was last assembled. The pass is only redone after
+     * the next linearization of the full domain.
+     */
+    void updateFlowsInfo() const
+    {
+        if (!flowsInfoOutdated_)
+            return;
+
+        OPM_TIMEBLOCK(updateFlowsInfo);
+        flowsInfoOutdated_ = false;
+        const bool enableFlows = flowsInfoRequested_ && !flowsInfo_.empty();
+        const bool enableFlores = floresInfoRequested_ && !floresInfo_.empty();
+        if (!enableFlows && !enableFlores)
+            return;
+
+        const unsigned numCells = nbRowStart_.size() - 1;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
+            VectorBlock flux;
+            VectorBlock darcyFlux;
+            short loc = 0;
+            for (unsigned nbIdx = nbRowStart_[globI]; nbIdx < nbRowStart_[globI + 1]; ++nbIdx, ++loc) {
+                const unsigned globJ = nbNeighbor_[nbIdx];
+                const ResidualNBInfo& nbInfo = nbResInfo_[nbIdx];
+                const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
+                if constexpr (scalarFluxKernelAvailable) {
+                    LocalResidual::computeFlux(flux, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo);
+                }
+                else {
+                    ADVectorBlock adflux(0.0);
+                    ADVectorBlock addarcy(0.0);
+                    LocalResidual::computeFlux(adflux, addarcy, globI, globJ, intQuantsIn, intQuantsEx, nbInfo);
+                    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                        flux[eqIdx] = adflux[eqIdx].value();
+                        darcyFlux[eqIdx] = addarcy[eqIdx].value();
+                    }
+                }
+                flux *= nbInfo.faceArea;
+                if (enableFlows) {
+                    for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
+                        flowsInfo_[globI][loc].flow[phaseIdx] = flux[phaseIdx];
+                    }
+                }
+                if (enableFlores) {
+                    for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
+                        floresInfo_[globI][loc].flow[phaseIdx] = darcyFlux[phaseIdx];
+                    }
+                }
+            }
+        }
+    }
+
     /*!
      * \brief Return constant reference to the velocityInfo.
      *
@@ -418,22 +596,24 @@ private:
     void createMatrix_()
     {
         OPM_TIMEBLOCK(createMatrix);
-        if (!neighborInfo_.empty()) {
+        if (!nbRowStart_.empty()) {
             // It is ok to call this function multiple times, but it
             // should not do anything if already called.
             return;
         }
         const auto& model = model_();
-        Stencil stencil(gridView_(), model_().dofMapper());
+        Stencil stencil = model_().createStencil();
 
         // for the main model, find out the global indices of the neighboring degrees of
         // freedom of each primary degree of freedom
-        using NeighborSet = std::set< unsigned >;
-        std::vector<NeighborSet> sparsityPattern(model.numTotalDof());
         const Scalar gravity = problem_().gravity()[dimWorld - 1];
         unsigned numCells = model.numTotalDof();
-        neighborInfo_.reserve(numCells, 6 * numCells);
-        std::vector<NeighborInfo> loc_nbinfo;
+        nbRowStart_.reserve(numCells + 1);
+        nbNeighbor_.reserve(6 * numCells);
+        nbResInfo_.reserve(6 * numCells);
+        nbRowStart_.push_back(0);
+        std::vector<unsigned> rowCell;
+        rowCell.reserve(numCells);
         const auto& materialLawManager = problem_().materialLawManager();
         using FaceDirection = FaceDir::DirEnum;
         for (const auto& elem : elements(gridView_())) {
@@ -441,11 +621,10 @@ private:
 
             for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
                 unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
-                loc_nbinfo.resize(stencil.numDof() - 1); // Do not include the primary dof in neighborInfo_
 
+                // Do not include the primary dof in the neighbor information
                 for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
                     unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern[myIdx].insert(neighborIdx);
                     if (dofIdx > 0) {
                         const Scalar trans = problem_().transmissibility(myIdx, neighborIdx);
                         const auto scvfIdx = dofIdx - 1;
@@ -457,29 +636,38 @@ private:
                         const Scalar zEx = problem_().dofCenterDepth(neighborIdx);
                         const Scalar dZg = (zIn - zEx)*gravity;
                         const Scalar thpres = problem_().thresholdPressure(myIdx, neighborIdx);
-                        Scalar inAlpha {0.};
-                        Scalar outAlpha {0.};
                         FaceDirection dirId = FaceDirection::Unknown;
-                        Scalar diffusivity {0.};
-                        Scalar dispersivity {0.};
+                        if (materialLawManager->hasDirectionalRelperms()) {
+                            dirId = scvf.faceDirFromDirId();
+                        }
+                        ResidualNBInfo nbinfo{};
+                        nbinfo.trans = trans;
+                        nbinfo.faceArea = area;
+                        nbinfo.thpres = thpres;
+                        nbinfo.dZg = dZg;
+                        nbinfo.faceDirection = dirId;
+                        nbinfo.Vin = Vin;
+                        nbinfo.Vex = Vex;
+                        // the coefficients of the optional modules are only stored if
+                        // the respective module is enabled at compile time
                         if constexpr(enableEnergy){
-                            inAlpha = problem_().thermalHalfTransmissibility(myIdx, neighborIdx);
-                            outAlpha = problem_().thermalHalfTransmissibility(neighborIdx, myIdx);
+                            nbinfo.inAlpha = problem_().thermalHalfTransmissibility(myIdx, neighborIdx);
+                            nbinfo.outAlpha = problem_().thermalHalfTransmissibility(neighborIdx, myIdx);
                         }
                         if constexpr(enableDiffusion){
-                            diffusivity = problem_().diffusivity(myIdx, neighborIdx);
-                        }
-                        if (simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion()) {
-                            dispersivity = problem_().dispersivity(myIdx, neighborIdx);
+                            nbinfo.diffusivity = problem_().diffusivity(myIdx, neighborIdx);
                         }
-                        if (materialLawManager->hasDirectionalRelperms()) {
-                            dirId = scvf.faceDirFromDirId();
+                        if constexpr(enableDispersion){
+                            if (simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion()) {
+                                nbinfo.dispersivity = problem_().dispersivity(myIdx, neighborIdx);
+                            }
                         }
-                        loc_nbinfo[dofIdx - 1] = NeighborInfo{neighborIdx, {trans, area, thpres, dZg, dirId, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity}, nullptr};
-
+                        nbNeighbor_.push_back(neighborIdx);
+                        nbResInfo_.push_back(nbinfo);
                     }
                 }
-                neighborInfo_.appendRow(loc_nbinfo.begin(), loc_nbinfo.end());
+                nbRowStart_.push_back(nbNeighbor_.size());
+                rowCell.push_back(myIdx);
                 if (problem_().nonTrivialBoundaryConditions()) {
                     for (unsigned bfIndex = 0; bfIndex < stencil.numBoundaryFaces(); ++bfIndex) {
                         const auto& bf = stencil.boundaryFace(bfIndex);
@@ -507,28 +695,158 @@ private:
             }
         }
 
+        // index the boundary information by cell so that the boundary terms of a
+        // sub-domain can be found without visiting all boundary faces
+        std::stable_sort(boundaryInfo_.begin(), boundaryInfo_.end(),
+                         [](const BoundaryInfo& a, const BoundaryInfo& b)
+                         { return a.cell < b.cell; });
+        boundaryInfoStart_.assign(numCells + 1, 0);
+        for (const auto& bdyInfo : boundaryInfo_)
+            ++boundaryInfoStart_[bdyInfo.cell + 1];
+        std::partial_sum(boundaryInfoStart_.begin(), boundaryInfoStart_.end(), boundaryInfoStart_.begin());
+
+        // the rows were appended in the order of the grid traversal. if the DOF mapper
+        // does not number the cells in that order (cf. ReorderedMapper), bring them into
+        // the order of the DOF indices.
+        if (!std::is_sorted(rowCell.begin(), rowCell.end()))
+            sortNeighborRows_(rowCell);
+
+        // the sparsity pattern of the cells is given by the neighbor information
+        SparsityPattern sparsityPattern;
+        {
+            using Connection = SparsityPattern::Connection;
+            std::vector<std::vector<Connection>> connections(1);
+            connections[0].reserve(numCells + nbNeighbor_.size());
+            for (unsigned globI = 0; globI < numCells; ++globI) {
+                connections[0].emplace_back(globI, globI);
+                for (unsigned nbIdx = nbRowStart_[globI]; nbIdx < nbRowStart_[globI + 1]; ++nbIdx)
+                    connections[0].emplace_back(globI, nbNeighbor_[nbIdx]);
+            }
+            sparsityPattern.assign(model.numTotalDof(), connections);
+        }
+
         // add the additional neighbors and degrees of freedom caused by the auxiliary
         // equations
         size_t numAuxMod = model.numAuxiliaryModules();
-        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+        if (numAuxMod > 0) {
+            std::vector<std::set<unsigned>> auxNeighbors(model.numTotalDof());
+            for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+                model.auxiliaryModule(auxModIdx)->addNeighbors(auxNeighbors);
+            sparsityPattern.merge(auxNeighbors);
+        }
 
         // allocate raw matrix
         jacobian_.reset(new SparseMatrixAdapter(simulator_()));
         diagMatAddress_.resize(numCells);
         // create matrix structure based on sparsity pattern
         jacobian_->reserve(sparsityPattern);
+        nbMatBlockAddress_.resize(nbNeighbor_.size());
         for (unsigned globI = 0; globI < numCells; globI++) {
-            const auto& nbInfos = neighborInfo_[globI];
             diagMatAddress_[globI] = jacobian_->blockAddress(globI, globI);
-            for (auto& nbInfo : nbInfos) {
-                nbInfo.matBlockAddress = jacobian_->blockAddress(nbInfo.neighbor, globI);
+            for (unsigned nbIdx = nbRowStart_[globI]; nbIdx < nbRowStart_[globI + 1]; ++nbIdx) {
+                nbMatBlockAddress_[nbIdx] = jacobian_->blockAddress(nbNeighbor_[nbIdx], globI);
             }
         }
 
         // Create dummy full domain.
         fullDomain_.cells.resize(numCells);
         std::iota(fullDomain_.cells.begin(), fullDomain_.cells.end(), 0);
+
+        if (useFaceBasedAssembly_)
+            createFaces_();
+
+        // initial guess for the cost of linearizing a cell until run times have been
+        // measured: the storage and source terms plus one flux per connection
+        std::vector<double> cellCost(numCells, 1.0);
+        if (!useFaceBasedAssembly_) {
+            for (unsigned globI = 0; globI < numCells; ++globI)
+                cellCost[globI] += nbRowStart_[globI + 1] - nbRowStart_[globI];
+        }
+        cellScheduler_.setCosts(std::move(cellCost));
+    }
+
+    // Permute the rows of the neighbor information such that row i belongs to the
+    // degree of freedom with index i.
+    void sortNeighborRows_(const std::vector<unsigned>& rowCell)
+    {
+        const std::size_t numRows = rowCell.size();
+        std::vector<unsigned> rowOfCell(numRows);
+        for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            rowOfCell[rowCell[rowIdx]] = rowIdx;
+
+        std::vector<unsigned> rowStart(numRows + 1, 0);
+        std::vector<unsigned> neighbor;
+        std::vector<ResidualNBInfo> resInfo;
+        neighbor.reserve(nbNeighbor_.size());
+        resInfo.reserve(nbResInfo_.size());
+        for (unsigned globI = 0; globI < numRows; ++globI) {
+            const unsigned rowIdx = rowOfCell[globI];
+            for (unsigned nbIdx = nbRowStart_[rowIdx]; nbIdx < nbRowStart_[rowIdx + 1]; ++nbIdx) {
+                neighbor.push_back(nbNeighbor_[nbIdx]);
+                resInfo.push_back(nbResInfo_[nbIdx]);
+            }
+            rowStart[globI + 1] = neighbor.size();
+        }
+
+        nbRowStart_ = std::move(rowStart);
+        nbNeighbor_ = std::move(neighbor);
+        nbResInfo_ = std::move(resInfo);
+    }
+
+    // Build the list of unique interior faces used by the face based assembly. The
+    // faces are greedily colored such that no two faces of the same color are
+    // adjacent to the same cell, i.e., all faces of a color can be linearized
+    // concurrently without any locking.
+    void createFaces_()
+    {
+        OPM_TIMEBLOCK(createFaces);
+        const unsigned numCells = model_().numTotalDof();
+        std::vector<FaceInfo> faces;
+        std::vector<unsigned> faceColor;
+        std::vector<std::vector<unsigned>> cellColors(numCells);
+        std::vector<bool> colorUsed;
+        unsigned numColors = 0;
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            for (unsigned nbIdxIn = nbRowStart_[globI]; nbIdxIn < nbRowStart_[globI + 1]; ++nbIdxIn) {
+                const unsigned globJ = nbNeighbor_[nbIdxIn];
+                if (globJ < globI)
+                    continue; // the face has already been seen from the other side
+
+                unsigned nbIdxEx = nbRowStart_[globJ];
+                while (nbIdxEx < nbRowStart_[globJ + 1] && nbNeighbor_[nbIdxEx] != globI)
+                    ++nbIdxEx;
+                if (nbIdxEx == nbRowStart_[globJ + 1])
+                    OPM_THROW(std::logic_error,
+                              "Connection between cells " + std::to_string(globI)
+                              + " and " + std::to_string(globJ) + " is not symmetric");
+
+                // find the smallest color not yet used by any face of either cell
+                colorUsed.assign(numColors + 1, false);
+                for (unsigned c : cellColors[globI])
+                    colorUsed[c] = true;
+                for (unsigned c : cellColors[globJ])
+                    colorUsed[c] = true;
+                unsigned color = 0;
+                while (colorUsed[color])
+                    ++color;
+                numColors = std::max(numColors, color + 1);
+                cellColors[globI].push_back(color);
+                cellColors[globJ].push_back(color);
+
+                faces.push_back(FaceInfo{globI, globJ, nbIdxIn, nbIdxEx});
+                faceColor.push_back(color);
+            }
+        }
+
+        // sort the faces by color
+        faceColorOffsets_.assign(numColors + 1, 0);
+        for (unsigned color : faceColor)
+            ++faceColorOffsets_[color + 1];
+        std::partial_sum(faceColorOffsets_.begin(), faceColorOffsets_.end(), faceColorOffsets_.begin());
+        faces_.resize(faces.size());
+        std::vector<std::size_t> pos(faceColorOffsets_.begin(), faceColorOffsets_.end() - 1);
+        for (std::size_t faceIdx = 0; faceIdx < faces.size(); ++faceIdx)
+            faces_[pos[faceColor[faceIdx]]++] = faces[faceIdx];
     }
 
     // reset the global linear system of equations.
@@ -548,17 +866,19 @@ private:
         // If DISPERC is in the deck, we initialize the sparse table here as well.
         const bool anyFlows = simulator_().problem().eclWriter()->eclOutputModule().anyFlows();
         const bool anyFlores = simulator_().problem().eclWriter()->eclOutputModule().anyFlores();                         
-        const bool enableDispersion = simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion();
-        if (((!anyFlows || !flowsInfo_.empty()) && (!anyFlores || !floresInfo_.empty())) && !enableDispersion) {
+        const bool dispersionActive = simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion();
+        if (((!anyFlows || !flowsInfo_.empty()) && (!anyFlores || !floresInfo_.empty())) && !dispersionActive) {
             return;
         }
         const auto& model = model_();
         const auto& nncOutput = simulator_().problem().eclWriter()->getOutputNnc();
-        Stencil stencil(gridView_(), model_().dofMapper());
+        Stencil stencil = model_().createStencil();
         unsigned numCells = model.numTotalDof();
         std::unordered_multimap<int, std::pair<int, int>> nncIndices;
-        std::vector<FlowInfo> loc_flinfo;
-        std::vector<VelocityInfo> loc_vlinfo;
+        // the rows are collected in the order of the grid traversal but must be stored
+        // in the order of the DOF indices (cf. ReorderedMapper)
+        std::vector<std::vector<FlowInfo>> flowRows(numCells);
+        std::vector<std::vector<VelocityInfo>> velocityRows(numCells);
         unsigned int nncId = 0;
         VectorBlock flow(0.0);
 
@@ -575,7 +895,7 @@ private:
         if (anyFlores) {
             floresInfo_.reserve(numCells, 6 * numCells);
         }
-        if (enableDispersion) {
+        if (dispersionActive) {
             velocityInfo_.reserve(numCells, 6 * numCells);
         }
 
@@ -583,6 +903,8 @@ private:
             stencil.update(elem);
             for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
                 unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+                auto& loc_flinfo = flowRows[myIdx];
+                auto& loc_vlinfo = velocityRows[myIdx];
                 loc_flinfo.resize(stencil.numDof() - 1);
                 loc_vlinfo.resize(stencil.numDof() - 1);
                 for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
@@ -591,8 +913,12 @@ private:
                         const auto scvfIdx = dofIdx - 1;
                         const auto& scvf = stencil.interiorFace(scvfIdx);
                         int faceId = scvf.dirId();
-                        const int cartMyIdx = simulator_().vanguard().cartesianIndex(myIdx);
-                        const int cartNeighborIdx = simulator_().vanguard().cartesianIndex(neighborIdx);
+                        // the vanguard expects the indices of the grid's natural numbering
+                        const auto& dofMapper = model.dofMapper();
+                        const int cartMyIdx =
+                            simulator_().vanguard().cartesianIndex(naturalIndex(dofMapper, myIdx));
+                        const int cartNeighborIdx =
+                            simulator_().vanguard().cartesianIndex(naturalIndex(dofMapper, neighborIdx));
                         const auto& range = nncIndices.equal_range(cartMyIdx);
                         for (auto it = range.first; it != range.second; ++it) {
                             if (it->second.first == cartNeighborIdx){
@@ -606,15 +932,18 @@ private:
                         loc_vlinfo[dofIdx - 1] = VelocityInfo{flow};
                     }
                 }
-                if (anyFlows) {
-                    flowsInfo_.appendRow(loc_flinfo.begin(), loc_flinfo.end());
-                }
-                if (anyFlores) {
-                    floresInfo_.appendRow(loc_flinfo.begin(), loc_flinfo.end());
-                }
-                if (enableDispersion) {
-                    velocityInfo_.appendRow(loc_vlinfo.begin(), loc_vlinfo.end());
-                }
+            }
+        }
+
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            if (anyFlows) {
+                flowsInfo_.appendRow(flowRows[globI].begin(), flowRows[globI].end());
+            }
+            if (anyFlores) {
+                floresInfo_.appendRow(flowRows[globI].begin(), flowRows[globI].end());
+            }
+            if (dispersionActive) {
+                velocityInfo_.appendRow(velocityRows[globI].begin(), velocityRows[globI].end());
             }
         }
     }
@@ -654,20 +983,30 @@ private:
         // We do not call resetSystem_() here, since that will set
         // the full system to zero, not just our part.
         // Instead, that must be called before starting the linearization.
-        const bool& enableDispersion = simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion();
-        const bool& enableFlows = simulator_().problem().eclWriter()->eclOutputModule().hasFlows() ||
-                                    simulator_().problem().eclWriter()->eclOutputModule().hasBlockFlows();
-        const bool& enableFlores = simulator_().problem().eclWriter()->eclOutputModule().hasFlores();
+        const bool& dispersionActive = simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion();
         const unsigned int numCells = domain.cells.size();
         const bool on_full_domain = (numCells == model_().numTotalDof());
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-        for (unsigned ii = 0; ii < numCells; ++ii) {
+        // sub-domains may be linearized concurrently, so only the linearization of the
+        // full domain touches the state shared by all cells
+        if (on_full_domain) {
+            flowsInfoRequested_ = simulator_().problem().eclWriter()->eclOutputModule().hasFlows() ||
+                                  simulator_().problem().eclWriter()->eclOutputModule().hasBlockFlows();
+            floresInfoRequested_ = simulator_().problem().eclWriter()->eclOutputModule().hasFlores();
+            flowsInfoOutdated_ = true;
+        }
+
+        // The face based assembly is only used for the full domain: for a subdomain,
+        // the faces on its boundary would have to be treated separately.
+        const bool faceBased = useFaceBasedAssembly_ && on_full_domain;
+        if constexpr (faceFluxKernelAvailable) {
+            if (faceBased)
+                linearizeFaces_();
+        }
+
+        const auto linearizeCell = [&](unsigned ii) {
             OPM_TIMEBLOCK_LOCAL(linearizationForEachCell);
             const unsigned globI = domain.cells[ii];
-            const auto& nbInfos = neighborInfo_[globI];
             VectorBlock res(0.0);
             MatrixBlock bMat(0.0);
             ADVectorBlock adres(0.0);
@@ -675,33 +1014,28 @@ private:
             const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
 
             // Flux term.
-            {
+            if (!faceBased) {
             OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachCell);
             short loc = 0;
-            for (const auto& nbInfo : nbInfos) {
+            for (unsigned nbIdx = nbRowStart_[globI]; nbIdx < nbRowStart_[globI + 1]; ++nbIdx) {
                 OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
-                unsigned globJ = nbInfo.neighbor;
+                unsigned globJ = nbNeighbor_[nbIdx];
+                const ResidualNBInfo& nbInfo = nbResInfo_[nbIdx];
                 assert(globJ != globI);
                 res = 0.0;
                 bMat = 0.0;
                 adres = 0.0;
                 darcyFlux = 0.0;
                 const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
-                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo);
-                adres *= nbInfo.res_nbinfo.faceArea;
-                if (enableDispersion) {
-                    for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
-                        velocityInfo_[globI][loc].velocity[phaseIdx] = darcyFlux[phaseIdx].value() / nbInfo.res_nbinfo.faceArea;
-                    }
-                }
-                if (enableFlows) {
-                    for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
-                        flowsInfo_[globI][loc].flow[phaseIdx] = adres[phaseIdx].value();
-                    }
-                }
-                if (enableFlores) {
-                    for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
-                        floresInfo_[globI][loc].flow[phaseIdx] = darcyFlux[phaseIdx].value();
+                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo);
+                adres *= nbInfo.faceArea;
+                // the dispersion velocities are needed by the physics, the flows and
+                // flores are only computed for the output. (see updateFlowsInfo().)
+                if constexpr (enableDispersion) {
+                    if (dispersionActive) {
+                        for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
+                            velocityInfo_[globI][loc].velocity[phaseIdx] = darcyFlux[phaseIdx].value() / nbInfo.faceArea;
+                        }
                     }
                 }
                 setResAndJacobi(res, bMat, adres);
@@ -710,7 +1044,7 @@ private:
                 *diagMatAddress_[globI] += bMat;
                 bMat *= -1.0;
                 //SparseAdapter syntax: jacobian_->addToBlock(globJ, globI, bMat);
-                *nbInfo.matBlockAddress += bMat;
+                *nbMatBlockAddress_[nbIdx] += bMat;
                 ++loc;
             }
             }
@@ -745,7 +1079,10 @@ private:
                             // otherwise this will be left un-updated.
                             model_().updateCachedStorage(globI, /*timeIdx=*/1, res);
                         }
-                    } else {
+                    } else if (!model_().previousStorageCached()) {
+                        // Unless it was computed when the time level was advanced,
+                        // calculate it from the intensive quantities of the previous
+                        // time level.
                         Dune::FieldVector<Scalar, numEq> tmp;
                         IntensiveQuantities intQuantOld = model_().intensiveQuantities(globI, 1);
                         LocalResidual::computeStorage(tmp, intQuantOld);
@@ -782,7 +1119,23 @@ private:
             residual_[globI] += res;
             //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
             *diagMatAddress_[globI] += bMat;
-        } // end of loop for cell globI.
+        }; // end of linearizeCell
+
+        // The cost of the cells differs considerably, so the loop over the full domain
+        // is balanced using the run times measured during the previous linearizations.
+        if (on_full_domain) {
+            cellScheduler_.run(linearizeCell);
+        }
+        else {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (unsigned ii = 0; ii < numCells; ++ii) {
+                linearizeCell(ii);
+            }
+        }
+        if (on_full_domain && model_().newtonMethod().numIterations() == 0)
+            storageCacheTime_ = simulator_().time();
 
         // Add sparse source terms. For now only wells.
         if (separateSparseSourceTerms_) {
@@ -790,7 +1143,7 @@ private:
         }
 
         // Boundary terms. Only looping over cells with nontrivial bcs.
-        for (const auto& bdyInfo : boundaryInfo_) {
+        forEachBoundaryInfo_(domain, [&](const BoundaryInfo& bdyInfo) {
             VectorBlock res(0.0);
             MatrixBlock bMat(0.0);
             ADVectorBlock adres(0.0);
@@ -802,12 +1155,217 @@ private:
             residual_[globI] += res;
             ////SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
             *diagMatAddress_[globI] += bMat;
+        });
+    }
+
+    // Evaluate the residual without the derivatives. This follows linearize_() but
+    // evaluates the storage with plain scalars, uses the value-only flux kernel if the
+    // local residual provides one and never writes to the Jacobian.
+    template <class SubDomainType>
+    void evaluateResidual_(const SubDomainType& domain)
+    {
+        OPM_TIMEBLOCK(evaluateResidual);
+        const unsigned int numCells = domain.cells.size();
+        // the cached storage of the beginning of the time step is only valid once the
+        // first linearization of the time step has updated it
+        const bool useStorageCache = model_().enableStorageCache()
+            && (model_().newtonMethod().numIterations() > 0
+                || storageCacheTime_ == simulator_().time());
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned ii = 0; ii < numCells; ++ii) {
+            const unsigned globI = domain.cells[ii];
+            const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
+            VectorBlock res(0.0);
+
+            // Flux term.
+            VectorBlock flux;
+            for (unsigned nbIdx = nbRowStart_[globI]; nbIdx < nbRowStart_[globI + 1]; ++nbIdx) {
+                const unsigned globJ = nbNeighbor_[nbIdx];
+                const ResidualNBInfo& nbInfo = nbResInfo_[nbIdx];
+                const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
+                if constexpr (scalarFluxKernelAvailable) {
+                    VectorBlock darcyFlux;
+                    LocalResidual::computeFlux(flux, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo);
+                }
+                else {
+                    ADVectorBlock adflux(0.0);
+                    ADVectorBlock darcyFlux(0.0);
+                    LocalResidual::computeFlux(adflux, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo);
+                    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                        flux[eqIdx] = adflux[eqIdx].value();
+                }
+                flux *= nbInfo.faceArea;
+                res += flux;
+            }
+
+            // Accumulation term.
+            const double dt = simulator_().timeStepSize();
+            const double volume = model_().dofTotalVolume(globI);
+            VectorBlock storage;
+            LocalResidual::computeStorage(storage, intQuantsIn);
+            if (useStorageCache) {
+                storage -= model_().cachedStorage(globI, 1);
+            } else {
+                VectorBlock storageOld;
+                LocalResidual::computeStorage(storageOld, model_().intensiveQuantities(globI, 1));
+                storage -= storageOld;
+            }
+            storage *= volume / dt;
+            res += storage;
+
+            // Cell-wise source terms. The problem only provides them with derivatives.
+            ADVectorBlock adres(0.0);
+            if (separateSparseSourceTerms_) {
+                LocalResidual::computeSourceDense(adres, problem_(), globI, 0);
+            } else {
+                LocalResidual::computeSource(adres, problem_(), globI, 0);
+            }
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                res[eqIdx] -= volume * adres[eqIdx].value();
+
+            residual_[globI] += res;
+        }
+
+        // Add sparse source terms. The well model also adds the derivatives to the
+        // diagonal blocks, so it is given addresses of a scratch block to keep the
+        // Jacobian intact.
+        if (separateSparseSourceTerms_) {
+            MatrixBlock scratchBlock(0.0);
+            std::vector<MatrixBlock*> scratchAddress(diagMatAddress_.size(), &scratchBlock);
+            problem_().wellModel().addReservoirSourceTerms(residual_, scratchAddress);
+        }
+
+        // Boundary terms.
+        forEachBoundaryInfo_(domain, [&](const BoundaryInfo& bdyInfo) {
+            const unsigned globI = bdyInfo.cell;
+            ADVectorBlock adres(0.0);
+            const IntensiveQuantities& insideIntQuants = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
+            LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, insideIntQuants, globI);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                residual_[globI][eqIdx] += bdyInfo.bcdata.faceArea * adres[eqIdx].value();
+        });
+    }
+
+    // call a functor for the boundary information of all cells of a domain
+    template <class SubDomainType, class Functor>
+    void forEachBoundaryInfo_(const SubDomainType& domain, Functor&& fn) const
+    {
+        if (domain.cells.size() == model_().numTotalDof()) {
+            for (const auto& bdyInfo : boundaryInfo_)
+                fn(bdyInfo);
+            return;
+        }
+
+        for (int globI : domain.cells)
+            for (unsigned idx = boundaryInfoStart_[globI]; idx < boundaryInfoStart_[globI + 1]; ++idx)
+                fn(boundaryInfo_[idx]);
+    }
+
+    // Linearize the flux terms by visiting each interior face once. This must not run
+    // concurrently with anything else which modifies the linear system because the
+    // results are added to both cells adjacent to a face. The face based kernel is not
+    // available if dispersion is enabled, so no velocities need to be recorded.
+    void linearizeFaces_()
+    {
+        OPM_TIMEBLOCK(linearizeFaces);
+        using FaceRateVector = typename LocalResidual::FaceRateVector;
+        const std::size_t numColors = faceColorOffsets_.empty() ? 0 : faceColorOffsets_.size() - 1;
+        for (std::size_t color = 0; color < numColors; ++color) {
+            const std::size_t faceBegin = faceColorOffsets_[color];
+            const std::size_t faceEnd = faceColorOffsets_[color + 1];
+            if constexpr (batchedFaceFluxKernelAvailable) {
+                // the faces of a color do not share any cells, so each batch can be
+                // added to the linear system without synchronization
+                const std::size_t numBatches = (faceEnd - faceBegin + faceFluxBatchSize - 1)/faceFluxBatchSize;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+                for (std::size_t batchIdx = 0; batchIdx < numBatches; ++batchIdx) {
+                    OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFaceBatch);
+                    using FaceBatchLane = typename LocalResidual::FaceBatchLane;
+                    const std::size_t batchBegin = faceBegin + batchIdx*faceFluxBatchSize;
+                    const unsigned numFaces = std::min<std::size_t>(faceFluxBatchSize, faceEnd - batchBegin);
+
+                    std::array<FaceBatchLane, faceFluxBatchSize> lanes;
+                    for (unsigned lane = 0; lane < numFaces; ++lane) {
+                        const FaceInfo& face = faces_[batchBegin + lane];
+                        lanes[lane] = FaceBatchLane{face.cellIn,
+                                                    face.cellEx,
+                                                    &model_().intensiveQuantities(face.cellIn, /*timeIdx*/ 0),
+                                                    &model_().intensiveQuantities(face.cellEx, /*timeIdx*/ 0),
+                                                    &nbResInfo_[face.nbIdxIn],
+                                                    &nbResInfo_[face.nbIdxEx]};
+                    }
+
+                    std::array<FaceRateVector, faceFluxBatchSize> adres;
+                    std::array<ADVectorBlock, faceFluxBatchSize> darcyFlux;
+                    LocalResidual::template computeFaceFluxBatch<faceFluxBatchSize>(adres.data(),
+                                                                                    darcyFlux.data(),
+                                                                                    lanes.data(),
+                                                                                    numFaces);
+                    for (unsigned lane = 0; lane < numFaces; ++lane)
+                        addFaceFlux_(batchBegin + lane, adres[lane]);
+                }
+            }
+            else {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+                for (std::size_t faceIdx = faceBegin; faceIdx < faceEnd; ++faceIdx) {
+                    OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
+                    const FaceInfo& face = faces_[faceIdx];
+                    FaceRateVector adres(0.0);
+                    ADVectorBlock darcyFlux(0.0);
+                    const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(face.cellIn, /*timeIdx*/ 0);
+                    const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(face.cellEx, /*timeIdx*/ 0);
+                    LocalResidual::computeFaceFlux(adres, darcyFlux, face.cellIn, face.cellEx,
+                                                   intQuantsIn, intQuantsEx,
+                                                   nbResInfo_[face.nbIdxIn], nbResInfo_[face.nbIdxEx]);
+                    addFaceFlux_(faceIdx, adres);
+                }
+            }
+        }
+    }
+
+    // add the flux over an interior face and its derivatives to the linear system
+    template <class FaceRateVector>
+    void addFaceFlux_(std::size_t faceIdx, FaceRateVector& adres)
+    {
+        const auto& face = faces_[faceIdx];
+        const unsigned globI = face.cellIn;
+        const unsigned globJ = face.cellEx;
+        adres *= nbResInfo_[face.nbIdxIn].faceArea;
+
+        VectorBlock res(0.0);
+        MatrixBlock bMatIn(0.0);
+        MatrixBlock bMatEx(0.0);
+        for (unsigned eqIdx = 0; eqIdx < numEq; eqIdx++) {
+            res[eqIdx] = adres[eqIdx].value();
+            for (unsigned pvIdx = 0; pvIdx < numEq; pvIdx++) {
+                bMatIn[eqIdx][pvIdx] = adres[eqIdx].derivative(pvIdx);
+                bMatEx[eqIdx][pvIdx] = adres[eqIdx].derivative(numEq + pvIdx);
+            }
         }
+
+        // the flux leaves the interior and enters the exterior cell
+        residual_[globI] += res;
+        residual_[globJ] -= res;
+        //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMatIn);
+        *diagMatAddress_[globI] += bMatIn;
+        //SparseAdapter syntax: jacobian_->addToBlock(globJ, globI, -bMatIn);
+        *nbMatBlockAddress_[face.nbIdxIn] -= bMatIn;
+        //SparseAdapter syntax: jacobian_->addToBlock(globI, globJ, bMatEx);
+        *nbMatBlockAddress_[face.nbIdxEx] += bMatEx;
+        //SparseAdapter syntax: jacobian_->addToBlock(globJ, globJ, -bMatEx);
+        *diagMatAddress_[globJ] -= bMatEx;
     }
 
     void updateStoredTransmissibilities()
     {
-        if (neighborInfo_.empty()) {
+        if (nbRowStart_.empty()) {
             // This function was called before createMatrix_() was called.
             // We call initFirstIteration_(), not createMatrix_(), because
             // that will also initialize the residual consistently.
@@ -818,10 +1376,9 @@ private:
 #pragma omp parallel for
 #endif
         for (unsigned globI = 0; globI < numCells; globI++) {
-            auto nbInfos = neighborInfo_[globI]; // nbInfos will be a SparseTable<...>::mutable_iterator_range.
-            for (auto& nbInfo : nbInfos) {
-                unsigned globJ = nbInfo.neighbor;
-                nbInfo.res_nbinfo.trans = problem_().transmissibility(globI, globJ);
+            for (unsigned nbIdx = nbRowStart_[globI]; nbIdx < nbRowStart_[globI + 1]; ++nbIdx) {
+                unsigned globJ = nbNeighbor_[nbIdx];
+                nbResInfo_[nbIdx].trans = problem_().transmissibility(globI, globJ);
             }
         }
     }
@@ -838,14 +1395,31 @@ private:
     LinearizationType linearizationType_;
 
     using ResidualNBInfo = typename LocalResidual::ResidualNBInfo;
-    struct NeighborInfo
+    // The information about the neighbors of the cells is stored as a structure of
+    // arrays in compressed row format: The connections of cell globI are located at
+    // the indices [nbRowStart_[globI], nbRowStart_[globI + 1]) of the remaining
+    // arrays. This way, the index of the neighbor and the address of the
+    // off-diagonal matrix block are not interleaved with the parameters needed by the
+    // local residual which in turn only contains the coefficients of the enabled
+    // modules.
+    std::vector<unsigned int> nbRowStart_;
+    std::vector<unsigned int> nbNeighbor_;
+    std::vector<MatrixBlock*> nbMatBlockAddress_;
+    std::vector<ResidualNBInfo> nbResInfo_;
+    std::vector<MatrixBlock*> diagMatAddress_;
+
+    // an interior face as used by the face based assembly. cellIn is always the cell
+    // with the smaller index and nbIdxIn/nbIdxEx are the indices of the face in the
+    // neighbor arrays for the interior and the exterior cell.
+    struct FaceInfo
     {
-        unsigned int neighbor;
-        ResidualNBInfo res_nbinfo;
-        MatrixBlock* matBlockAddress;
+        unsigned int cellIn;
+        unsigned int cellEx;
+        unsigned int nbIdxIn;
+        unsigned int nbIdxEx;
     };
-    SparseTable<NeighborInfo> neighborInfo_;
-    std::vector<MatrixBlock*> diagMatAddress_;
+    std::vector<FaceInfo> faces_;
+    std::vector<std::size_t> faceColorOffsets_;
 
     struct FlowInfo
     {
@@ -853,8 +1427,13 @@ private:
         VectorBlock flow;
         unsigned int nncId;
     };
-    SparseTable<FlowInfo> flowsInfo_;
-    SparseTable<FlowInfo> floresInfo_;
+    // the flows and flores are computed lazily from the currently cached intensive
+    // quantities after a linearization marked them outdated, see updateFlowsInfo()
+    mutable SparseTable<FlowInfo> flowsInfo_;
+    mutable SparseTable<FlowInfo> floresInfo_;
+    mutable bool flowsInfoOutdated_ = false;
+    bool flowsInfoRequested_ = false;
+    bool floresInfoRequested_ = false;
 
     struct VelocityInfo
     {
@@ -880,7 +1459,15 @@ private:
         BoundaryConditionData bcdata;
     };
     std::vector<BoundaryInfo> boundaryInfo_;
+    // the boundary information of cell i is boundaryInfo_[boundaryInfoStart_[i]] to
+    // boundaryInfo_[boundaryInfoStart_[i + 1] - 1]
+    std::vector<unsigned> boundaryInfoStart_;
     bool separateSparseSourceTerms_ = false;
+    bool useFaceBasedAssembly_ = false;
+    CostBalancedLoopScheduler cellScheduler_;
+    // the time at which the cached storage of the beginning of the time step was
+    // updated by the last linearization
+    Scalar storageCacheTime_ = std::numeric_limits<Scalar>::lowest();
     struct FullDomain
     {
         std::vector<int> cells;
@@ -0,0 +1,397 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::EcfvCompactStencil
+ */
+#ifndef EWOMS_ECFV_COMPACT_STENCIL_HH
+#define EWOMS_ECFV_COMPACT_STENCIL_HH
+
+#include "ecfvstencil.hh"
+
+#include <dune/grid/common/gridenums.hh>
+#include <dune/grid/common/rangegenerators.hh>
+#include <dune/common/fvector.hh>
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \ingroup EcfvDiscretization
+ *
+ * \brief A variant of EcfvStencil which only stores indices.
+ *
+ * EcfvStencil copies the Dune entities of the element and all its neighbors and
+ * recomputes the geometry of the faces on each update. This stencil instead refers to
+ * a table which contains the geometry of all elements and faces of the grid view. The
+ * table is created by the discretization and shared by all of its stencils, see
+ * EcfvDiscretization::createStencil(). Updating the stencil thus only means to look up
+ * the index of the element.
+ *
+ * The elements of the neighbors are not available, i.e., element(dofIdx) as well as
+ * the geometry() and localGeometry() methods of the sub-control volumes may only be
+ * used for the central element. Since the table is computed once, this stencil cannot
+ * be used with grid adaptation.
+ */
+template <class Scalar,
+          class GridView,
+          bool needFaceIntegrationPos = true,
+          bool needFaceNormal = true,
+          class ElementMapperT = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>>
+class EcfvCompactStencil
+{
+    enum { dimWorld = GridView::dimensionworld };
+
+    using CoordScalar = typename GridView::ctype;
+    using Element = typename GridView::template Codim<0>::Entity;
+    using ElementGeometry = typename Element::Geometry;
+    using ElementLocalGeometry = typename Element::LocalGeometry;
+    using ElementMapper = ElementMapperT;
+    using GlobalPosition = Dune::FieldVector<CoordScalar, dimWorld>;
+
+    using FullStencil = EcfvStencil<Scalar, GridView, needFaceIntegrationPos, needFaceNormal, ElementMapperT>;
+
+public:
+    using Entity = Element;
+    using Mapper = ElementMapper;
+
+    using SubControlVolumeFace = typename FullStencil::SubControlVolumeFace;
+    using BoundaryFace = typename FullStencil::BoundaryFace;
+
+    /*!
+     * \brief Represents a sub-control volume, i.e., an element.
+     */
+    class SubControlVolume
+    {
+        friend class EcfvCompactStencil;
+
+    public:
+        SubControlVolume()
+        {}
+
+        explicit SubControlVolume(const Element& element)
+            : center_(element.geometry().center())
+            , volume_(element.geometry().volume())
+        {}
+
+        /*!
+         * \brief The global position associated with the sub-control volume
+         */
+        const GlobalPosition& globalPos() const
+        { return center_; }
+
+        /*!
+         * \brief The center of the sub-control volume
+         */
+        const GlobalPosition& center() const
+        { return center_; }
+
+        /*!
+         * \brief The volume [m^3] occupied by the sub-control volume
+         */
+        Scalar volume() const
+        { return volume_; }
+
+        /*!
+         * \brief The geometry of the sub-control volume.
+         *
+         * This is only available for the central element of the stencil.
+         */
+        ElementGeometry geometry() const
+        {
+            assert(element_);
+            return element_->geometry();
+        }
+
+        /*!
+         * \brief Geometry of the sub-control volume relative to parent.
+         *
+         * This is only available for the central element of the stencil.
+         */
+        ElementLocalGeometry localGeometry() const
+        {
+            assert(element_);
+            return element_->geometryInFather();
+        }
+
+    private:
+        GlobalPosition center_;
+        Scalar volume_;
+
+        // the element of the sub-control volume. only set for the central element.
+        const Element* element_ = nullptr;
+    };
+
+    /*!
+     * \brief The geometry of all elements and faces of a grid view.
+     *
+     * The faces of each element are stored contiguously in the same order in which
+     * EcfvStencil visits them, so the local indices of the degrees of freedom are the
+     * same for both stencils.
+     */
+    class GeometryTable
+    {
+    public:
+        GeometryTable(const GridView& gridView, const ElementMapper& mapper)
+        {
+            const std::size_t numElements = mapper.size();
+            scv_.resize(numElements);
+            partitionType_.resize(numElements);
+            faceStart_.assign(numElements + 1, 0);
+            boundaryFaceStart_.assign(numElements + 1, 0);
+
+            // count the faces of each element
+            for (const auto& elem : elements(gridView)) {
+                const unsigned elemIdx = mapper.index(elem);
+                for (const auto& intersection : intersections(gridView, elem)) {
+                    if (intersection.neighbor())
+                        ++faceStart_[elemIdx + 1];
+                    else
+                        ++boundaryFaceStart_[elemIdx + 1];
+                }
+            }
+            for (std::size_t elemIdx = 0; elemIdx < numElements; ++elemIdx) {
+                faceStart_[elemIdx + 1] += faceStart_[elemIdx];
+                boundaryFaceStart_[elemIdx + 1] += boundaryFaceStart_[elemIdx];
+            }
+            neighbor_.resize(faceStart_[numElements]);
+            faces_.resize(faceStart_[numElements]);
+            boundaryFaces_.resize(boundaryFaceStart_[numElements]);
+
+            // compute the geometry
+            for (const auto& elem : elements(gridView)) {
+                const unsigned elemIdx = mapper.index(elem);
+                scv_[elemIdx] = SubControlVolume(elem);
+                partitionType_[elemIdx] = elem.partitionType();
+
+                std::size_t faceIdx = faceStart_[elemIdx];
+                std::size_t boundaryFaceIdx = boundaryFaceStart_[elemIdx];
+                for (const auto& intersection : intersections(gridView, elem)) {
+                    if (intersection.neighbor()) {
+                        const unsigned localNeighborIdx = faceIdx - faceStart_[elemIdx] + 1;
+                        neighbor_[faceIdx] = mapper.index(intersection.outside());
+                        faces_[faceIdx++] = SubControlVolumeFace(intersection, localNeighborIdx);
+                    }
+                    else
+                        boundaryFaces_[boundaryFaceIdx++] = BoundaryFace(intersection, - 10000);
+                }
+            }
+        }
+
+        std::size_t numElements() const
+        { return scv_.size(); }
+
+        std::vector<SubControlVolume> scv_;
+        std::vector<Dune::PartitionType> partitionType_;
+
+        // the interior faces of element i are located at [faceStart_[i], faceStart_[i + 1])
+        std::vector<std::size_t> faceStart_;
+        std::vector<unsigned> neighbor_;
+        std::vector<SubControlVolumeFace> faces_;
+
+        std::vector<std::size_t> boundaryFaceStart_;
+        std::vector<BoundaryFace> boundaryFaces_;
+    };
+
+    /*!
+     * \brief Create a stencil which refers to a given geometry table.
+     *
+     * The table must have been created for the same grid view and element mapper.
+     */
+    EcfvCompactStencil(const GridView& gridView,
+                       const Mapper& mapper,
+                       std::shared_ptr<const GeometryTable> table)
+        : gridView_(gridView)
+        , elementMapper_(mapper)
+        , table_(std::move(table))
+    {
+        // try to ensure that the mapper passed indeed maps elements
+        assert(int(gridView.size(/*codim=*/0)) == int(elementMapper_.size()));
+        assert(table_ && table_->numElements() == elementMapper_.size());
+    }
+
+    void updateTopology(const Element& element)
+    {
+        element_ = element;
+        elemIdx_ = static_cast<unsigned>(elementMapper_.index(element));
+        primaryOnly_ = false;
+
+        centralScv_ = table_->scv_[elemIdx_];
+        centralScv_.element_ = &element_;
+    }
+
+    void updatePrimaryTopology(const Element& element)
+    {
+        updateTopology(element);
+        primaryOnly_ = true;
+    }
+
+    void update(const Element& element)
+    {
+        updateTopology(element);
+    }
+
+    void updateCenterGradients()
+    {
+        assert(false); // not yet implemented
+    }
+
+    /*!
+     * \brief Return the element to which the stencil refers.
+     */
+    const Element& element() const
+    { return element_; }
+
+    /*!
+     * \brief Return the grid view of the element to which the stencil
+     *        refers.
+     */
+    const GridView& gridView() const
+    { return gridView_; }
+
+    /*!
+     * \brief Returns the number of degrees of freedom which the
+     *        current element interacts with.
+     */
+    size_t numDof() const
+    { return 1 + numInteriorFaces(); }
+
+    /*!
+     * \brief Returns the number of degrees of freedom which are contained
+     *        by within the current element.
+     *
+     * For element centered finite elements, this is only the central DOF.
+     */
+    size_t numPrimaryDof() const
+    { return 1; }
+
+    /*!
+     * \brief Return the global space index given the index of a degree of
+     *        freedom.
+     */
+    unsigned globalSpaceIndex(unsigned dofIdx) const
+    {
+        assert(dofIdx < numDof());
+
+        if (dofIdx == 0)
+            return elemIdx_;
+        return table_->neighbor_[table_->faceStart_[elemIdx_] + dofIdx - 1];
+    }
+
+    /*!
+     * \brief Return partition type of a given degree of freedom
+     */
+    Dune::PartitionType partitionType(unsigned dofIdx) const
+    { return table_->partitionType_[globalSpaceIndex(dofIdx)]; }
+
+    /*!
+     * \brief Return the element given the index of a degree of freedom.
+     *
+     * Only the central element is available, i.e., dofIdx must be 0.
+     */
+    const Element& element(unsigned dofIdx) const
+    {
+        assert(dofIdx == 0);
+        static_cast<void>(dofIdx);
+
+        return element_;
+    }
+
+    /*!
+     * \brief Return the entity given the index of a degree of
+     *        freedom.
+     */
+    const Entity& entity(unsigned dofIdx) const
+    { return element(dofIdx); }
+
+    /*!
+     * \brief Returns the sub-control volume object belonging to a
+     *        given degree of freedom.
+     */
+    const SubControlVolume& subControlVolume(unsigned dofIdx) const
+    {
+        if (dofIdx == 0)
+            return centralScv_;
+        return table_->scv_[globalSpaceIndex(dofIdx)];
+    }
+
+    /*!
+     * \brief Returns the number of interior faces of the stencil.
+     */
+    size_t numInteriorFaces() const
+    {
+        if (primaryOnly_)
+            return 0;
+        return table_->faceStart_[elemIdx_ + 1] - table_->faceStart_[elemIdx_];
+    }
+
+    /*!
+     * \brief Returns the face object belonging to a given face index
+     *        in the interior of the domain.
+     */
+    const SubControlVolumeFace& interiorFace(unsigned faceIdx) const
+    {
+        assert(faceIdx < numInteriorFaces());
+        return table_->faces_[table_->faceStart_[elemIdx_] + faceIdx];
+    }
+
+    /*!
+     * \brief Returns the number of boundary faces of the stencil.
+     */
+    size_t numBoundaryFaces() const
+    {
+        if (primaryOnly_)
+            return 0;
+        return table_->boundaryFaceStart_[elemIdx_ + 1] - table_->boundaryFaceStart_[elemIdx_];
+    }
+
+    /*!
+     * \brief Returns the boundary face object belonging to a given
+     *        boundary face index.
+     */
+    const BoundaryFace& boundaryFace(unsigned bfIdx) const
+    {
+        assert(bfIdx < numBoundaryFaces());
+        return table_->boundaryFaces_[table_->boundaryFaceStart_[elemIdx_] + bfIdx];
+    }
+
+protected:
+    const GridView& gridView_;
+    const ElementMapper& elementMapper_;
+    std::shared_ptr<const GeometryTable> table_;
+
+    Element element_;
+    SubControlVolume centralScv_;
+    unsigned elemIdx_ = 0;
+    bool primaryOnly_ = false;
+};
+
+} // namespace Opm
+
+
+#endif
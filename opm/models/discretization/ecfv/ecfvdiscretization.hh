@@ -32,12 +32,18 @@
 
 #include "ecfvproperties.hh"
 #include "ecfvstencil.hh"
+#include "ecfvcompactstencil.hh"
 #include "ecfvgridcommhandlefactory.hh"
 #include "ecfvbaseoutputmodule.hh"
 
 #include <opm/simulators/linalg/elementborderlistfromgrid.hh>
 #include <opm/models/discretization/common/fvbasediscretization.hh>
 
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
 #if HAVE_DUNE_FEM
 #include <opm/models/discretization/common/fvbasediscretizationfemadapt.hh>
 #include <dune/fem/space/common/functionspace.hh>
@@ -58,11 +64,18 @@ struct Stencil<TypeTag, TTag::EcfvDiscretization>
 private:
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using ElementMapper = GetPropType<TypeTag, Properties::ElementMapper>;
 
 public:
-    using type = EcfvStencil<Scalar, GridView>;
+    using type = std::conditional_t<getPropValue<TypeTag, Properties::UseCompactStencil>(),
+                                    EcfvCompactStencil<Scalar, GridView, true, true, ElementMapper>,
+                                    EcfvStencil<Scalar, GridView, true, true, ElementMapper>>;
 };
 
+//! By default, the stencils store copies of the neighboring elements
+template<class TypeTag>
+struct UseCompactStencil<TypeTag, TTag::EcfvDiscretization> { static constexpr bool value = false; };
+
 //! Mapper for the degrees of freedoms.
 template<class TypeTag>
 struct DofMapper<TypeTag, TTag::EcfvDiscretization> { using type = GetPropType<TypeTag, Properties::ElementMapper>; };
@@ -137,6 +150,18 @@ struct UseLinearizationLock<TypeTag, TTag::EcfvDiscretization> { static constexp
 } // namespace Opm::Properties
 
 namespace Opm {
+namespace detail {
+// the pointer to the geometry table which is shared by compact stencils. the other
+// stencils do not have such a table, so their GeometryTable type must not be named.
+template <class Stencil, bool useCompactStencil>
+struct EcfvGeometryTablePointer
+{ using type = std::nullptr_t; };
+
+template <class Stencil>
+struct EcfvGeometryTablePointer<Stencil, /*useCompactStencil=*/true>
+{ using type = std::shared_ptr<const typename Stencil::GeometryTable>; };
+} // namespace detail
+
 /*!
  * \ingroup EcfvDiscretization
  *
@@ -152,11 +177,28 @@ class EcfvDiscretization : public GetPropType<TypeTag, Properties::BaseDiscretiz
     using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using Stencil = GetPropType<TypeTag, Properties::Stencil>;
+
+    enum { useCompactStencil = getPropValue<TypeTag, Properties::UseCompactStencil>() };
+
+    using GeometryTablePointer =
+        typename detail::EcfvGeometryTablePointer<Stencil, bool(useCompactStencil)>::type;
 
 public:
     EcfvDiscretization(Simulator& simulator)
         : ParentType(simulator)
-    { }
+    {
+        if constexpr (useCompactStencil) {
+            if (this->enableGridAdaptation())
+                throw std::invalid_argument("Compact stencils cannot be used in conjunction "
+                                            "with grid adaptation");
+
+            // the geometry of the grid which is shared by all stencils
+            geometryTable_ =
+                std::make_shared<const typename Stencil::GeometryTable>(this->gridView_,
+                                                                        this->elementMapper());
+        }
+    }
 
     /*!
      * \brief Returns a string of discretization's human-readable name
@@ -177,6 +219,19 @@ public:
     const DofMapper& dofMapper() const
     { return this->elementMapper(); }
 
+    /*!
+     * \copydoc FvBaseDiscretization::createStencil
+     *
+     * Compact stencils refer to the geometry table of the discretization.
+     */
+    Stencil createStencil() const
+    {
+        if constexpr (useCompactStencil)
+            return Stencil(this->gridView_, this->elementMapper(), geometryTable_);
+        else
+            return ParentType::createStencil();
+    }
+
     /*!
      * \brief Syncronize the values of the primary variables on the
      *        degrees of freedom that overlap with the neighboring
@@ -231,6 +286,9 @@ private:
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    // the geometry which is shared by all compact stencils
+    GeometryTablePointer geometryTable_;
 };
 } // namespace Opm
 
@@ -41,6 +41,16 @@ namespace TTag {
 struct EcfvDiscretization { using InheritsFrom = std::tuple<FvBaseDiscretization>; };
 } // end namespace TTag
 
+/*!
+ * \brief Use a stencil which refers to a precomputed table of the grid geometry
+ *        instead of storing copies of the neighboring elements.
+ *
+ * This reduces the memory traffic of the element contexts, but it cannot be used
+ * together with grid adaptation and the elements of the neighbors are unavailable.
+ */
+template<class TypeTag, class MyTypeTag>
+struct UseCompactStencil { using type = UndefinedProperty; };
+
 } // namespace Opm::Properties
 
 #endif
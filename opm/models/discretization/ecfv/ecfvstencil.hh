@@ -56,7 +56,8 @@ namespace Opm {
 template <class Scalar,
           class GridView,
           bool needFaceIntegrationPos = true,
-          bool needFaceNormal = true>
+          bool needFaceNormal = true,
+          class ElementMapperT = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>>
 class EcfvStencil
 {
     enum { dimWorld = GridView::dimensionworld };
@@ -65,7 +66,7 @@ class EcfvStencil
     using Intersection = typename GridView::Intersection;
     using Element = typename GridView::template Codim<0>::Entity;
 
-    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using ElementMapper = ElementMapperT;
 
     using GlobalPosition = Dune::FieldVector<CoordScalar, dimWorld>;
 
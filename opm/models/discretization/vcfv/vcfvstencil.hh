@@ -462,7 +462,9 @@ VcfvScvGeometries<Scalar, /*dim=*/3, ElementType::cube>::scvGeoms_[
  * are constructed by connecting the element's center with each edge
  * of the element.
  */
-template <class Scalar, class GridView>
+template <class Scalar,
+          class GridView,
+          class VertexMapperT = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>>
 class VcfvStencil
 {
     enum{dim = GridView::dimension};
@@ -722,7 +724,7 @@ private:
 
 public:
     //! exported Mapper type
-    using Mapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using Mapper = VertexMapperT;
 
     class ScvGeometry
     {
@@ -1379,9 +1381,9 @@ private:
 };
 
 #if HAVE_DUNE_LOCALFUNCTIONS
-template<class Scalar, class GridView>
-typename VcfvStencil<Scalar, GridView>::LocalFiniteElementCache
-VcfvStencil<Scalar, GridView>::feCache_;
+template<class Scalar, class GridView, class VertexMapperT>
+typename VcfvStencil<Scalar, GridView, VertexMapperT>::LocalFiniteElementCache
+VcfvStencil<Scalar, GridView, VertexMapperT>::feCache_;
 #endif // HAVE_DUNE_LOCALFUNCTIONS
 
 } // namespace Opm
@@ -34,6 +34,7 @@
 #include <opm/models/utils/basicproperties.hh>
 #include <opm/models/common/multiphasebaseproperties.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/discretization/common/reorderedmapper.hh>
 
 #include <dune/istl/bvector.hh>
 #include <dune/common/fvector.hh>
@@ -318,7 +319,7 @@ protected:
                              BufferType bufferType = DofBuffer)
     {
         if (bufferType == DofBuffer)
-            DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer, name);
+            attachScalarDofData_(baseWriter, buffer, name);
         else if (bufferType == VertexBuffer)
             attachScalarVertexData_(baseWriter, buffer, name);
         else if (bufferType == ElementBuffer)
@@ -336,7 +337,7 @@ protected:
                              BufferType bufferType = DofBuffer)
     {
         if (bufferType == DofBuffer)
-            DiscBaseOutputModule::attachVectorDofData_(baseWriter, buffer, name);
+            attachVectorDofData_(baseWriter, buffer, name);
         else if (bufferType == VertexBuffer)
             attachVectorVertexData_(baseWriter, buffer, name);
         else if (bufferType == ElementBuffer)
@@ -354,7 +355,7 @@ protected:
                              BufferType bufferType = DofBuffer)
     {
         if (bufferType == DofBuffer)
-            DiscBaseOutputModule::attachTensorDofData_(baseWriter, buffer, name);
+            attachTensorDofData_(baseWriter, buffer, name);
         else if (bufferType == VertexBuffer)
             attachTensorVertexData_(baseWriter, buffer, name);
         else if (bufferType == ElementBuffer)
@@ -377,7 +378,7 @@ protected:
             snprintf(name, 512, pattern, eqName.c_str());
 
             if (bufferType == DofBuffer)
-                DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
+                attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
                 attachScalarVertexData_(baseWriter, buffer[i], name);
             else if (bufferType == ElementBuffer)
@@ -402,7 +403,7 @@ protected:
             snprintf(name, 512, pattern, oss.str().c_str());
 
             if (bufferType == DofBuffer)
-                DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
+                attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
                 attachScalarVertexData_(baseWriter, buffer[i], name);
             else if (bufferType == ElementBuffer)
@@ -425,7 +426,7 @@ protected:
             snprintf(name, 512, pattern, FluidSystem::phaseName(i));
 
             if (bufferType == DofBuffer)
-                DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
+                attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
                 attachScalarVertexData_(baseWriter, buffer[i], name);
             else if (bufferType == ElementBuffer)
@@ -448,7 +449,7 @@ protected:
             snprintf(name, 512, pattern, FluidSystem::componentName(i));
 
             if (bufferType == DofBuffer)
-                DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i], name);
+                attachScalarDofData_(baseWriter, buffer[i], name);
             else if (bufferType == VertexBuffer)
                 attachScalarVertexData_(baseWriter, buffer[i], name);
             else if (bufferType == ElementBuffer)
@@ -474,7 +475,7 @@ protected:
                          FluidSystem::componentName(j));
 
                 if (bufferType == DofBuffer)
-                    DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer[i][j], name);
+                    attachScalarDofData_(baseWriter, buffer[i][j], name);
                 else if (bufferType == VertexBuffer)
                     attachScalarVertexData_(baseWriter, buffer[i][j], name);
                 else if (bufferType == ElementBuffer)
@@ -485,35 +486,79 @@ protected:
         }
     }
 
+    // the buffers are indexed by the model's mappers while the writers expect the
+    // grid's natural numbering of the entities. (see ReorderedMapper.)
+    void attachScalarDofData_(BaseOutputWriter& baseWriter,
+                              ScalarBuffer& buffer,
+                              const std::string& name)
+    {
+        restoreNaturalOrder(simulator_.model().dofMapper(), buffer);
+        DiscBaseOutputModule::attachScalarDofData_(baseWriter, buffer, name);
+    }
+
+    void attachVectorDofData_(BaseOutputWriter& baseWriter,
+                              VectorBuffer& buffer,
+                              const std::string& name)
+    {
+        restoreNaturalOrder(simulator_.model().dofMapper(), buffer);
+        DiscBaseOutputModule::attachVectorDofData_(baseWriter, buffer, name);
+    }
+
+    void attachTensorDofData_(BaseOutputWriter& baseWriter,
+                              TensorBuffer& buffer,
+                              const std::string& name)
+    {
+        restoreNaturalOrder(simulator_.model().dofMapper(), buffer);
+        DiscBaseOutputModule::attachTensorDofData_(baseWriter, buffer, name);
+    }
+
     void attachScalarElementData_(BaseOutputWriter& baseWriter,
                                   ScalarBuffer& buffer,
                                   const char *name)
-    { baseWriter.attachScalarElementData(buffer, name); }
+    {
+        restoreNaturalOrder(simulator_.model().elementMapper(), buffer);
+        baseWriter.attachScalarElementData(buffer, name);
+    }
 
     void attachScalarVertexData_(BaseOutputWriter& baseWriter,
                                  ScalarBuffer& buffer,
                                  const char *name)
-    { baseWriter.attachScalarVertexData(buffer, name); }
+    {
+        restoreNaturalOrder(simulator_.model().vertexMapper(), buffer);
+        baseWriter.attachScalarVertexData(buffer, name);
+    }
 
     void attachVectorElementData_(BaseOutputWriter& baseWriter,
                                   VectorBuffer& buffer,
                                   const char *name)
-    { baseWriter.attachVectorElementData(buffer, name); }
+    {
+        restoreNaturalOrder(simulator_.model().elementMapper(), buffer);
+        baseWriter.attachVectorElementData(buffer, name);
+    }
 
     void attachVectorVertexData_(BaseOutputWriter& baseWriter,
                                  VectorBuffer& buffer,
                                  const char *name)
-    { baseWriter.attachVectorVertexData(buffer, name); }
+    {
+        restoreNaturalOrder(simulator_.model().vertexMapper(), buffer);
+        baseWriter.attachVectorVertexData(buffer, name);
+    }
 
     void attachTensorElementData_(BaseOutputWriter& baseWriter,
                                   TensorBuffer& buffer,
                                   const char *name)
-    { baseWriter.attachTensorElementData(buffer, name); }
+    {
+        restoreNaturalOrder(simulator_.model().elementMapper(), buffer);
+        baseWriter.attachTensorElementData(buffer, name);
+    }
 
     void attachTensorVertexData_(BaseOutputWriter& baseWriter,
                                  TensorBuffer& buffer,
                                  const char *name)
-    { baseWriter.attachTensorVertexData(buffer, name); }
+    {
+        restoreNaturalOrder(simulator_.model().vertexMapper(), buffer);
+        baseWriter.attachTensorVertexData(buffer, name);
+    }
 
     const Simulator& simulator_;
 };
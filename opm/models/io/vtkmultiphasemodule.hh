@@ -134,7 +134,6 @@ class VtkMultiPhaseModule : public BaseOutputModule<TypeTag>
 
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
-    using DiscBaseOutputModule = GetPropType<TypeTag, Properties::DiscBaseOutputModule>;
 
     static const int vtkFormat = getPropValue<TypeTag, Properties::VtkOutputFormat>();
     using VtkMultiWriter = ::Opm::VtkMultiWriter<GridView, vtkFormat>;
@@ -378,7 +377,7 @@ public:
                 char name[512];
                 snprintf(name, 512, "filterVelocity_%s", FluidSystem::phaseName(phaseIdx));
 
-                DiscBaseOutputModule::attachVectorDofData_(baseWriter, velocity_[phaseIdx], name);
+                this->attachVectorDofData_(baseWriter, velocity_[phaseIdx], name);
             }
         }
 
@@ -394,9 +393,9 @@ public:
                 char name[512];
                 snprintf(name, 512, "gradP_%s", FluidSystem::phaseName(phaseIdx));
 
-                DiscBaseOutputModule::attachVectorDofData_(baseWriter,
-                                                           potentialGradient_[phaseIdx],
-                                                           name);
+                this->attachVectorDofData_(baseWriter,
+                                           potentialGradient_[phaseIdx],
+                                           name);
             }
         }
     }
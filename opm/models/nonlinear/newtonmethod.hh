@@ -30,6 +30,7 @@
 #include "nullconvergencewriter.hh"
 
 #include "newtonmethodproperties.hh"
+#include "nlddsolver.hh"
 
 #include <opm/common/Exceptions.hpp>
 
@@ -45,6 +46,8 @@
 #include <dune/common/classname.hh>
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <algorithm>
+#include <exception>
 #include <iostream>
 #include <sstream>
 
@@ -97,6 +100,28 @@ template<class TypeTag>
 struct NewtonTargetIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 10; };
 template<class TypeTag>
 struct NewtonMaxIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 20; };
+// the nonlinear domain decomposition is disabled by default
+template<class TypeTag>
+struct NewtonNumLocalDomains<TypeTag, TTag::NewtonMethod> { static constexpr int value = 1; };
+template<class TypeTag>
+struct NewtonMaxLocalIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 10; };
+// the Jacobian is re-assembled in each iteration by default
+template<class TypeTag>
+struct NewtonMaxJacobianReuse<TypeTag, TTag::NewtonMethod> { static constexpr int value = 0; };
+template<class TypeTag>
+struct NewtonJacobianReuseMaxContraction<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.5;
+};
+template<class TypeTag>
+struct NewtonUseEisenstatWalker<TypeTag, TTag::NewtonMethod> { static constexpr bool value = false; };
+template<class TypeTag>
+struct NewtonMaxForcingTerm<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.1;
+};
 
 } // namespace Opm::Properties
 
@@ -136,12 +161,23 @@ public:
         , linearSolver_(simulator)
         , comm_(Dune::MPIHelper::getCommunicator())
         , convergenceWriter_(asImp_())
+        , nlddSolver_(simulator)
     {
         lastError_ = 1e100;
         error_ = 1e100;
         tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonTolerance);
 
         numIterations_ = 0;
+
+        maxJacobianReuse_ = EWOMS_GET_PARAM(TypeTag, int, NewtonMaxJacobianReuse);
+        jacobianReuseMaxContraction_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonJacobianReuseMaxContraction);
+        jacobianAge_ = 0;
+        lastContraction_ = 1.0;
+        contractionMeasured_ = false;
+
+        useEisenstatWalker_ = EWOMS_GET_PARAM(TypeTag, bool, NewtonUseEisenstatWalker);
+        maxForcingTerm_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxForcingTerm);
+        forcingTerm_ = maxForcingTerm_;
     }
 
     /*!
@@ -150,6 +186,7 @@ public:
     static void registerParameters()
     {
         LinearSolverBackend::registerParameters();
+        NlddSolver<TypeTag>::registerParameters();
 
         EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonVerbose,
                              "Specify whether the Newton method should inform "
@@ -170,6 +207,19 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonMaxError,
                              "The maximum error tolerated by the Newton "
                              "method to which does not cause an abort");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonMaxJacobianReuse,
+                             "The maximum number of consecutive Newton iterations "
+                             "which reuse the Jacobian matrix and the preconditioner "
+                             "of a previous iteration");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonJacobianReuseMaxContraction,
+                             "The maximum ratio of the errors of two consecutive Newton "
+                             "iterations for which the Jacobian matrix is reused");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, NewtonUseEisenstatWalker,
+                             "Adapt the tolerance of the linear solver to the progress "
+                             "of the Newton method");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonMaxForcingTerm,
+                             "The loosest residual reduction required from the linear "
+                             "solver if its tolerance is adapted to the Newton method");
     }
 
     /*!
@@ -296,6 +346,20 @@ public:
                 asImp_().beginIteration_();
                 prePostProcessTimer_.stop();
 
+                // solve the non-linear problems of the sub-domains. the global Newton
+                // step is skipped if this was sufficient for convergence.
+                if (nlddSolver_.enabled() && asImp_().numIterations() > 0) {
+                    if (asImp_().verbose_()) {
+                        std::cout << "Solve local problems"
+                                  << clearRemainingLine
+                                  << std::flush;
+                    }
+
+                    linearizeTimer_.start();
+                    asImp_().solveLocalProblems_();
+                    linearizeTimer_.stop();
+                }
+
                 // make the current solution to the old one
                 currentSolution = nextSolution;
 
@@ -305,10 +369,16 @@ public:
                               << std::flush;
                 }
 
-                // do the actual linearization
+                // do the actual linearization. if the Jacobian matrix of a previous
+                // iteration is reused, only the residual needs to be evaluated
+                const bool reuseJacobian = asImp_().reuseJacobian_();
                 linearizeTimer_.start();
-                asImp_().linearizeDomain_();
-                asImp_().linearizeAuxiliaryEquations_();
+                if (reuseJacobian)
+                    asImp_().linearizeResidual_();
+                else {
+                    asImp_().linearizeDomain_();
+                    asImp_().linearizeAuxiliaryEquations_();
+                }
                 linearizeTimer_.stop();
 
                 solveTimer_.start();
@@ -326,6 +396,12 @@ public:
                 asImp_().preSolve_(currentSolution, residual);
                 updateTimer_.stop();
 
+                jacobianAge_ = reuseJacobian ? jacobianAge_ + 1 : 0;
+                if (asImp_().numIterations() > 0) {
+                    lastContraction_ = error_/std::max(lastError_, Scalar(1e-100));
+                    contractionMeasured_ = true;
+                }
+
                 if (!asImp_().proceed_()) {
                     if (asImp_().verbose_() && isatty(fileno(stdout)))
                         std::cout << clearRemainingLine
@@ -349,11 +425,40 @@ public:
                 solveTimer_.start();
                 // solve A x = b, where b is the residual, A is its Jacobian and x is the
                 // update of the solution
-                linearSolver_.setMatrix(jacobian);
+                if (!reuseJacobian)
+                    linearSolver_.setMatrix(jacobian);
+                if (useEisenstatWalker_) {
+                    forcingTerm_ = asImp_().computeForcingTerm_();
+                    linearSolver_.setResidualReductionTolerance(forcingTerm_);
+                }
                 solutionUpdate = 0.0;
                 bool converged = linearSolver_.solve(solutionUpdate);
                 solveTimer_.stop();
 
+                if (!converged && reuseJacobian) {
+                    // the outdated Jacobian matrix might be the culprit. try again with
+                    // an up-to-date one before giving up. the solution did not change,
+                    // so neither did the residual and its error.
+                    if (asImp_().verbose_())
+                        std::cout << "Newton: Linear solver did not converge using the "
+                                  << "reused Jacobian matrix\n" << std::flush;
+
+                    linearizeTimer_.start();
+                    asImp_().linearizeDomain_();
+                    asImp_().linearizeAuxiliaryEquations_();
+                    linearizeTimer_.stop();
+                    jacobianAge_ = 0;
+
+                    solveTimer_.start();
+                    linearSolver_.prepare(jacobian, residual);
+                    linearSolver_.setResidual(residual);
+                    linearSolver_.getResidual(residual);
+                    linearSolver_.setMatrix(jacobian);
+                    solutionUpdate = 0.0;
+                    converged = linearSolver_.solve(solutionUpdate);
+                    solveTimer_.stop();
+                }
+
                 if (!converged) {
                     solveTimer_.stop();
                     if (asImp_().verbose_())
@@ -545,6 +650,12 @@ protected:
     {
         numIterations_ = 0;
 
+        // the contraction of the previous time step or of a failed attempt says nothing
+        // about the current one
+        jacobianAge_ = 0;
+        lastContraction_ = 1.0;
+        contractionMeasured_ = false;
+
         if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
             convergenceWriter_.beginTimeStep();
     }
@@ -592,6 +703,71 @@ protected:
         model().linearizer().finalize();
     }
 
+    /*!
+     * \brief Returns true if the Jacobian matrix of a previous iteration should be
+     *        reused for the current one.
+     *
+     * The Jacobian is always assembled in the first iteration of a time step because it
+     * depends on the time step size. Afterwards, it is reused for at most
+     * NewtonMaxJacobianReuse iterations as long as the error decreases fast enough. This
+     * requires that the decrease of the error was measured in the current time step,
+     * so the Jacobian is assembled in the first two iterations.
+     * Auxiliary modules add their contributions to the matrix and the residual in one
+     * go, so the Jacobian is not reused if there are any. The same applies to
+     * linearizers which cannot evaluate the residual on its own.
+     */
+    bool reuseJacobian_() const
+    {
+        if (maxJacobianReuse_ <= 0 || !contractionMeasured_)
+            return false;
+        if (model().numAuxiliaryModules() > 0)
+            return false;
+        if (!model().linearizer().residualOnlyLinearization())
+            return false;
+
+        return jacobianAge_ < maxJacobianReuse_
+            && lastContraction_ <= jacobianReuseMaxContraction_;
+    }
+
+    /*!
+     * \brief Returns the residual reduction which the linear solver needs to achieve in
+     *        the current iteration.
+     *
+     * This is the second choice of the forcing terms proposed by Eisenstat and Walker
+     * (1996): The linear systems are solved more accurately as the Newton method starts
+     * to converge quadratically. The safeguards prevent the forcing term from decreasing
+     * too quickly and the linear solver from reducing the residual much further than
+     * required by the tolerance of the Newton method.
+     */
+    Scalar computeForcingTerm_() const
+    {
+        const Scalar gamma = 0.9;
+
+        if (asImp_().numIterations() < 1)
+            return maxForcingTerm_;
+
+        Scalar eta = gamma*lastContraction_*lastContraction_;
+
+        const Scalar safeguardEta = gamma*forcingTerm_*forcingTerm_;
+        if (safeguardEta > 0.1)
+            eta = std::max(eta, safeguardEta);
+
+        if (error_ > 0.0)
+            eta = std::max(eta, Scalar(0.5*tolerance_/error_));
+
+        return std::min(eta, maxForcingTerm_);
+    }
+
+    /*!
+     * \brief Evaluate the residual of the global non-linear system of equations without
+     *        updating the Jacobian matrix.
+     */
+    void linearizeResidual_()
+    {
+        model().linearizer().linearizeResidualOnly();
+        model().linearizer().finalize();
+    }
+
     void preSolve_(const SolutionVector&,
                    const GlobalEqVector& currentResidual)
     {
@@ -599,23 +775,37 @@ protected:
         lastError_ = error_;
         Scalar newtonMaxError = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError);
 
-        // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
+        // calculate the error as the maximum weighted tolerance of the solution's
+        // residual. auxiliary DOFs are not considered for the error.
+        const int numDof = static_cast<int>(std::min<size_t>(currentResidual.size(),
+                                                             model().numGridDof()));
         error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= model().numGridDof() || model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
-
-            // also do not consider DOFs which are constraint
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Scalar threadError = 0.0;
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+            for (int dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                if (model().dofTotalVolume(dofIdx) <= 0.0)
                     continue;
+
+                // also do not consider DOFs which are constraint
+                if (enableConstraints_()) {
+                    if (constraintsMap.count(dofIdx) > 0)
+                        continue;
+                }
+
+                threadError = max(asImp_().dofError_(dofIdx, currentResidual[dofIdx]),
+                                  threadError);
             }
 
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
-                error_ = max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error_);
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            error_ = max(threadError, error_);
         }
 
         // take the other processes into account
@@ -629,6 +819,20 @@ protected:
                                    + std::to_string(double(newtonMaxError)));
     }
 
+    /*!
+     * \brief Returns the maximum weighted residual of a degree of freedom.
+     *
+     * \param dofIdx The global index of the degree of freedom
+     * \param residual The residual of the degree of freedom
+     */
+    Scalar dofError_(unsigned dofIdx, const EqVector& residual) const
+    {
+        Scalar error = 0.0;
+        for (unsigned eqIdx = 0; eqIdx < residual.size(); ++eqIdx)
+            error = max(std::abs(residual[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error);
+        return error;
+    }
+
     /*!
      * \brief Update the error of the solution given the previous
      *        iteration.
@@ -700,14 +904,29 @@ protected:
         if (!std::isfinite(solutionUpdate.one_norm()))
             throw NumericalProblem("Non-finite update!");
 
-        size_t numGridDof = model().numGridDof();
-        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0) {
-                    const auto& constraints = constraintsMap.at(dofIdx);
-                    asImp_().updateConstraintDof_(dofIdx,
-                                                  nextSolution[dofIdx],
-                                                  constraints);
+        // the degrees of freedom are updated independently of each other. the
+        // implementations of updatePrimaryVariables_() must thus be thread safe, which
+        // is also required by the nonlinear domain decomposition.
+        const int numGridDof = static_cast<int>(model().numGridDof());
+        std::exception_ptr exceptionPtr = nullptr;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+            try {
+                if (enableConstraints_()) {
+                    if (constraintsMap.count(dofIdx) > 0) {
+                        const auto& constraints = constraintsMap.at(dofIdx);
+                        asImp_().updateConstraintDof_(dofIdx,
+                                                      nextSolution[dofIdx],
+                                                      constraints);
+                    }
+                    else
+                        asImp_().updatePrimaryVariables_(dofIdx,
+                                                         nextSolution[dofIdx],
+                                                         currentSolution[dofIdx],
+                                                         solutionUpdate[dofIdx],
+                                                         currentResidual[dofIdx]);
                 }
                 else
                     asImp_().updatePrimaryVariables_(dofIdx,
@@ -716,14 +935,17 @@ protected:
                                                      solutionUpdate[dofIdx],
                                                      currentResidual[dofIdx]);
             }
-            else
-                asImp_().updatePrimaryVariables_(dofIdx,
-                                                 nextSolution[dofIdx],
-                                                 currentSolution[dofIdx],
-                                                 solutionUpdate[dofIdx],
-                                                 currentResidual[dofIdx]);
+            catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                exceptionPtr = std::current_exception();
+            }
         }
 
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
         // update the DOFs of the auxiliary equations
         size_t numDof = model().numTotalDof();
         for (size_t dofIdx = numGridDof; dofIdx < numDof; ++dofIdx) {
@@ -732,6 +954,52 @@ protected:
         }
     }
 
+    /*!
+     * \brief Update the current solution of a subset of the degrees of freedom.
+     *
+     * This is used by the nonlinear domain decomposition. Only the entries of the
+     * vectors which correspond to the given degrees of freedom are accessed, so this
+     * may be called concurrently for disjoint sets of degrees of freedom.
+     *
+     * \param dofIndices The global indices of the degrees of freedom to be updated
+     */
+    template <class DofIndices>
+    void update_(SolutionVector& nextSolution,
+                 const SolutionVector& currentSolution,
+                 const GlobalEqVector& solutionUpdate,
+                 const GlobalEqVector& currentResidual,
+                 const DofIndices& dofIndices)
+    {
+        for (auto dofIdx : dofIndices)
+            asImp_().updatePrimaryVariables_(dofIdx,
+                                             nextSolution[dofIdx],
+                                             currentSolution[dofIdx],
+                                             solutionUpdate[dofIdx],
+                                             currentResidual[dofIdx]);
+    }
+
+    /*!
+     * \brief Solve the non-linear problems of the sub-domains of the nonlinear domain
+     *        decomposition.
+     */
+    void solveLocalProblems_()
+    {
+        if constexpr (NlddSolver<TypeTag>::available) {
+            const unsigned numFailed =
+                nlddSolver_.solve(tolerance(),
+                                  [this](SolutionVector& nextSolution,
+                                         const SolutionVector& currentSolution,
+                                         const GlobalEqVector& solutionUpdate,
+                                         const GlobalEqVector& currentResidual,
+                                         const std::vector<int>& cells)
+                                  {
+                                      asImp_().update_(nextSolution, currentSolution,
+                                                       solutionUpdate, currentResidual, cells);
+                                  });
+            endIterMsg() << ", unconverged domains: " << numFailed;
+        }
+    }
+
     /*!
      * \brief Update the primary variables for a degree of freedom which is constraint.
      */
@@ -880,6 +1148,18 @@ protected:
     // actual number of iterations done so far
     int numIterations_;
 
+    // reuse of the Jacobian matrix (chord method)
+    int maxJacobianReuse_;
+    Scalar jacobianReuseMaxContraction_;
+    int jacobianAge_; // number of iterations since the Jacobian was assembled
+    Scalar lastContraction_; // ratio of the errors of the last two iterations
+    bool contractionMeasured_; // lastContraction_ refers to the current time step
+
+    // adaptive accuracy of the linear solver (inexact Newton)
+    bool useEisenstatWalker_;
+    Scalar maxForcingTerm_;
+    Scalar forcingTerm_;
+
     // the linear solver
     LinearSolverBackend linearSolver_;
 
@@ -891,6 +1171,9 @@ protected:
     // method to disk
     ConvergenceWriter convergenceWriter_;
 
+    // solves the non-linear problems of the sub-domains (if enabled)
+    NlddSolver<TypeTag> nlddSolver_;
+
 private:
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -82,6 +82,51 @@ struct NewtonTargetIterations { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct NewtonMaxIterations { using type = UndefinedProperty; };
 
+/*!
+ * \brief The number of sub-domains used by the nonlinear domain decomposition.
+ *
+ * If this is larger than 1, the Newton method solves the non-linear problems of the
+ * sub-domains before each global iteration. This requires a linearizer which is able
+ * to linearize a set of cells, i.e., the TpfaLinearizer.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonNumLocalDomains { using type = UndefinedProperty; };
+
+//! The maximum number of Newton iterations for the non-linear problem of a sub-domain
+template<class TypeTag, class MyTypeTag>
+struct NewtonMaxLocalIterations { using type = UndefinedProperty; };
+
+/*!
+ * \brief The maximum number of consecutive Newton iterations which reuse the Jacobian
+ *        matrix and the preconditioner of a previous iteration.
+ *
+ * If this is larger than 0, only the residual is evaluated in these iterations, i.e.,
+ * the Newton method turns into a chord method. Zero disables the reuse.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonMaxJacobianReuse { using type = UndefinedProperty; };
+
+//! The maximum ratio of the errors of two consecutive Newton iterations for which the
+//! Jacobian matrix is reused
+template<class TypeTag, class MyTypeTag>
+struct NewtonJacobianReuseMaxContraction { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specifies whether the accuracy of the linear solver is adapted to the progress
+ *        of the Newton method.
+ *
+ * If this is true, the residual reduction required from the linear solver is chosen
+ * using the forcing terms of Eisenstat and Walker. It is never tighter than
+ * LinearSolverTolerance.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonUseEisenstatWalker { using type = UndefinedProperty; };
+
+//! The loosest residual reduction which is required from the linear solver if the
+//! accuracy of the linear solver is adapted to the progress of the Newton method
+template<class TypeTag, class MyTypeTag>
+struct NewtonMaxForcingTerm { using type = UndefinedProperty; };
+
 } // end namespace  Opm::Properties
 
 #endif
@@ -0,0 +1,488 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::NlddSolver
+ */
+#ifndef EWOMS_NLDD_SOLVER_HH
+#define EWOMS_NLDD_SOLVER_HH
+
+#include "newtonmethodproperties.hh"
+
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <opm/simulators/linalg/linalgproperties.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/grid/common/partitionset.hh>
+#include <dune/grid/common/rangegenerators.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+namespace detail {
+// find out whether a linearizer is able to linearize sub-domains which are given as a
+// list of cells
+template <class Linearizer, class = void>
+struct SupportsCellDomains : public std::false_type
+{};
+
+template <class Linearizer>
+struct SupportsCellDomains<Linearizer,
+                           std::void_t<decltype(std::declval<const Linearizer&>().concurrentDomainLinearization())>>
+    : public std::true_type
+{};
+
+// split a list of cells into numDomains domains of consecutive entries whose sizes
+// differ by at most one
+inline std::vector<std::vector<int>> splitCells(const std::vector<int>& cells, std::size_t numDomains)
+{
+    std::vector<std::vector<int>> domainCells(numDomains);
+    for (std::size_t domainIdx = 0; domainIdx < numDomains; ++domainIdx) {
+        const std::size_t begin = cells.size()*domainIdx/numDomains;
+        const std::size_t end = cells.size()*(domainIdx + 1)/numDomains;
+        domainCells[domainIdx].assign(cells.begin() + begin, cells.begin() + end);
+    }
+    return domainCells;
+}
+
+// the domains which are coupled to each domain by an entry of a matrix. rows and
+// columns which do not belong to any domain are ignored.
+template <class Matrix>
+std::vector<std::vector<unsigned>> domainNeighbors(const Matrix& matrix,
+                                                   const std::vector<std::vector<int>>& domainCells,
+                                                   const std::vector<unsigned>& cellDomain,
+                                                   unsigned noDomain)
+{
+    const std::size_t numDomains = domainCells.size();
+    std::vector<std::vector<unsigned>> neighbors(numDomains);
+    for (std::size_t domainIdx = 0; domainIdx < numDomains; ++domainIdx) {
+        auto& domainNeighbors = neighbors[domainIdx];
+        for (int globalIdx : domainCells[domainIdx]) {
+            const auto& row = matrix[globalIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                const unsigned colIdx = colIt.index();
+                if (colIdx < cellDomain.size() && cellDomain[colIdx] != noDomain && cellDomain[colIdx] != domainIdx)
+                    domainNeighbors.push_back(cellDomain[colIdx]);
+            }
+        }
+        std::sort(domainNeighbors.begin(), domainNeighbors.end());
+        domainNeighbors.erase(std::unique(domainNeighbors.begin(), domainNeighbors.end()),
+                              domainNeighbors.end());
+    }
+    return neighbors;
+}
+
+// greedy coloring of a graph with symmetric adjacency lists such that adjacent
+// vertices have different colors. returns the color of each vertex.
+inline std::vector<unsigned> greedyColoring(const std::vector<std::vector<unsigned>>& neighbors)
+{
+    // the graph is symmetric, so it is sufficient to only consider the already colored
+    // neighbors
+    std::vector<unsigned> color(neighbors.size(), 0);
+    std::vector<char> colorUsed;
+    unsigned numColors = 0;
+    for (std::size_t vertexIdx = 0; vertexIdx < neighbors.size(); ++vertexIdx) {
+        colorUsed.assign(numColors + 1, 0);
+        for (unsigned neighborIdx : neighbors[vertexIdx])
+            if (neighborIdx < vertexIdx)
+                colorUsed[color[neighborIdx]] = 1;
+
+        color[vertexIdx] = std::find(colorUsed.begin(), colorUsed.end(), 0) - colorUsed.begin();
+        numColors = std::max(numColors, color[vertexIdx] + 1);
+    }
+    return color;
+}
+} // namespace detail
+
+/*!
+ * \ingroup Newton
+ *
+ * \brief Solves the non-linear problems of the sub-domains of a nonlinear domain
+ *        decomposition (NLDD).
+ *
+ * The interior cells are split into NewtonNumLocalDomains sub-domains of consecutive
+ * cell indices, i.e., the sub-domains are compact if the cells are numbered in an order
+ * that preserves locality (cf. the DofOrdering parameter). For each sub-domain, Newton
+ * iterations are performed with the cells outside of the sub-domain kept fixed until
+ * its residual is below the tolerance or NewtonMaxLocalIterations is reached.
+ *
+ * The sub-domains are colored such that adjacent sub-domains have different colors.
+ * All sub-domains of a color are solved concurrently, the colors are processed one
+ * after the other (i.e., this is a multi-colored non-linear Gauss-Seidel method).
+ * Since the residual of a sub-domain only depends on its cells and their direct
+ * neighbors, the concurrently solved sub-domains do not interfere.
+ *
+ * This requires a linearizer which linearizes sub-domains given as lists of cells,
+ * i.e., the TpfaLinearizer.
+ */
+template <class TypeTag>
+class NlddSolver
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using Linearizer = GetPropType<TypeTag, Properties::Linearizer>;
+    using SolutionVector = GetPropType<TypeTag, Properties::SolutionVector>;
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using LocalMatrix = Dune::BCRSMatrix<MatrixBlock>;
+    using LocalVector = Dune::BlockVector<typename GlobalEqVector::block_type>;
+    using ElementSeed = typename GridView::template Codim<0>::Entity::EntitySeed;
+
+    // the residual reduction and the maximum number of iterations of the linear solver
+    // for the sub-domains. These are small, so solving them accurately is cheap.
+    static constexpr Scalar localLinearSolverReduction = 1e-3;
+    static constexpr int localLinearSolverMaxIterations = 200;
+
+    static constexpr unsigned noDomain = static_cast<unsigned>(-1);
+
+public:
+    //! Specifies whether the linearizer supports the nonlinear domain decomposition
+    static constexpr bool available = detail::SupportsCellDomains<Linearizer>::value;
+
+    /*!
+     * \brief A sub-domain as expected by Linearizer::linearizeDomain().
+     */
+    struct Domain
+    {
+        std::vector<int> cells;
+        unsigned color = 0;
+
+        // the Jacobian of the sub-domain and the blocks of the global Jacobian from
+        // which its entries are copied
+        LocalMatrix matrix;
+        std::vector<const MatrixBlock*> globalBlocks;
+    };
+
+    explicit NlddSolver(Simulator& simulator)
+        : simulator_(simulator)
+    {
+        numDomains_ = EWOMS_GET_PARAM(TypeTag, int, NewtonNumLocalDomains);
+        maxLocalIterations_ = EWOMS_GET_PARAM(TypeTag, int, NewtonMaxLocalIterations);
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the nonlinear domain decomposition.
+     */
+    static void registerParameters()
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonNumLocalDomains,
+                             "The number of sub-domains for which the non-linear problems are "
+                             "solved before each global Newton iteration. (1 disables the "
+                             "nonlinear domain decomposition.)");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonMaxLocalIterations,
+                             "The maximum number of Newton iterations for the non-linear "
+                             "problem of a sub-domain");
+    }
+
+    /*!
+     * \brief Returns true if the non-linear problems of the sub-domains ought to be
+     *        solved.
+     */
+    bool enabled() const
+    { return available && numDomains_ > 1 && maxLocalIterations_ > 0; }
+
+    /*!
+     * \brief Returns the sub-domains.
+     */
+    const std::vector<Domain>& domains() const
+    { return domains_; }
+
+    /*!
+     * \brief Solve the non-linear problems of all sub-domains.
+     *
+     * This must only be called after the Jacobian matrix of the full domain has been
+     * linearized at least once in the current time step.
+     *
+     * \param tolerance The maximum weighted residual for which a sub-domain is
+     *                  considered to be converged
+     * \param updateFn A functor which updates the primary variables of a list of cells,
+     *                 see NewtonMethod::update_()
+     * \return The number of sub-domains which did not converge
+     */
+    template <class UpdateFn>
+    unsigned solve(Scalar tolerance, UpdateFn&& updateFn)
+    {
+        setup_();
+
+        // if the sub-domains cannot be linearized concurrently, they are solved one
+        // after the other and the linearizer may use all threads for each of them
+        const bool concurrent = simulator_.model().linearizer().concurrentDomainLinearization();
+        unsigned numFailed = 0;
+        for (const auto& colorDomains : colorDomains_) {
+            const int numColorDomains = static_cast<int>(colorDomains.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) reduction(+:numFailed) if(concurrent)
+#endif
+            for (int i = 0; i < numColorDomains; ++i) {
+                if (!solveDomain_(domains_[colorDomains[i]], tolerance, updateFn))
+                    ++numFailed;
+            }
+        }
+
+        return numFailed;
+    }
+
+private:
+    // (re-)create the sub-domains if the Jacobian matrix has been re-allocated
+    void setup_()
+    {
+        const auto& model = simulator_.model();
+        const auto& jacobian = model.linearizer().jacobian().istlMatrix();
+        if (&jacobian == lastJacobian_ && jacobian.N() == lastNumRows_)
+            return;
+
+        lastJacobian_ = &jacobian;
+        lastNumRows_ = jacobian.N();
+
+        // the element of each cell, used to update the intensive quantities
+        const std::size_t numCells = model.numGridDof();
+        cellSeed_.resize(numCells);
+        std::vector<char> isInterior(numCells, 0);
+        const auto& gridView = simulator_.gridView();
+        for (const auto& elem : elements(gridView, Dune::Partitions::interior)) {
+            const unsigned globalIdx = model.dofMapper().index(elem);
+            cellSeed_[globalIdx] = elem.seed();
+            isInterior[globalIdx] = 1;
+        }
+
+        // split the interior cells into domains of consecutive indices
+        std::vector<int> interiorCells;
+        for (unsigned globalIdx = 0; globalIdx < numCells; ++globalIdx)
+            if (isInterior[globalIdx])
+                interiorCells.push_back(static_cast<int>(globalIdx));
+
+        const std::size_t numDomains =
+            std::max<std::size_t>(1, std::min<std::size_t>(numDomains_, interiorCells.size()));
+        const auto domainCells = detail::splitCells(interiorCells, numDomains);
+        domains_.clear();
+        domains_.resize(numDomains);
+        cellDomain_.assign(numCells, noDomain);
+        cellLocalIdx_.assign(numCells, 0);
+        for (std::size_t domainIdx = 0; domainIdx < numDomains; ++domainIdx) {
+            const auto& cells = domainCells[domainIdx];
+            domains_[domainIdx].cells = cells;
+            for (std::size_t localIdx = 0; localIdx < cells.size(); ++localIdx) {
+                cellDomain_[cells[localIdx]] = domainIdx;
+                cellLocalIdx_[cells[localIdx]] = localIdx;
+            }
+        }
+
+        // the couplings between the domains are given by the sparsity pattern of the
+        // Jacobian. domains which are coupled get different colors.
+        const auto neighbors = detail::domainNeighbors(jacobian, domainCells, cellDomain_, noDomain);
+        const auto color = detail::greedyColoring(neighbors);
+        colorDomains_.clear();
+        for (std::size_t domainIdx = 0; domainIdx < numDomains; ++domainIdx) {
+            domains_[domainIdx].color = color[domainIdx];
+            if (color[domainIdx] >= colorDomains_.size())
+                colorDomains_.resize(color[domainIdx] + 1);
+            colorDomains_[color[domainIdx]].push_back(domainIdx);
+        }
+
+        for (std::size_t domainIdx = 0; domainIdx < numDomains; ++domainIdx)
+            createLocalMatrix_(domains_[domainIdx], domainIdx, jacobian);
+
+        currentSolution_ = model.solution(/*timeIdx=*/0);
+        update_.resize(model.numTotalDof());
+        update_ = 0.0;
+    }
+
+    // create the sparsity pattern of the Jacobian of a domain
+    template <class GlobalMatrix>
+    void createLocalMatrix_(Domain& domain, std::size_t domainIdx, const GlobalMatrix& jacobian)
+    {
+        const std::size_t numLocalCells = domain.cells.size();
+        auto& matrix = domain.matrix;
+        matrix.setBuildMode(LocalMatrix::random);
+        matrix.setSize(numLocalCells, numLocalCells);
+        for (std::size_t localIdx = 0; localIdx < numLocalCells; ++localIdx)
+            matrix.setrowsize(localIdx, localColumns_(domain.cells[localIdx], domainIdx, jacobian).size());
+        matrix.endrowsizes();
+        for (std::size_t localIdx = 0; localIdx < numLocalCells; ++localIdx)
+            for (unsigned colIdx : localColumns_(domain.cells[localIdx], domainIdx, jacobian))
+                matrix.addindex(localIdx, colIdx);
+        matrix.endindices();
+
+        domain.globalBlocks.clear();
+        for (std::size_t localIdx = 0; localIdx < numLocalCells; ++localIdx) {
+            const auto& globalRow = jacobian[domain.cells[localIdx]];
+            const auto& row = matrix[localIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+                domain.globalBlocks.push_back(&globalRow[domain.cells[colIt.index()]]);
+        }
+    }
+
+    // the local column indices of the entries of a row of the global Jacobian which
+    // belong to a domain
+    template <class GlobalMatrix>
+    std::vector<unsigned> localColumns_(int globalIdx, std::size_t domainIdx, const GlobalMatrix& jacobian) const
+    {
+        std::vector<unsigned> columns;
+        const auto& row = jacobian[globalIdx];
+        for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+            const unsigned colIdx = colIt.index();
+            if (colIdx < cellDomain_.size() && cellDomain_[colIdx] == domainIdx)
+                columns.push_back(cellLocalIdx_[colIdx]);
+        }
+        return columns;
+    }
+
+    // Newton iterations for a single domain. If the domain could not be linearized, its
+    // solution is reset to the one at the beginning.
+    template <class UpdateFn>
+    bool solveDomain_(Domain& domain, Scalar tolerance, UpdateFn& updateFn)
+    {
+        auto& model = simulator_.model();
+        auto& linearizer = model.linearizer();
+        SolutionVector& solution = model.solution(/*timeIdx=*/0);
+        const auto& residual = linearizer.residual();
+
+        for (int globalIdx : domain.cells)
+            currentSolution_[globalIdx] = solution[globalIdx];
+        std::vector<typename SolutionVector::block_type> initialSolution;
+        initialSolution.reserve(domain.cells.size());
+        for (int globalIdx : domain.cells)
+            initialSolution.push_back(solution[globalIdx]);
+
+        ElementContext elemCtx(simulator_);
+        LocalVector x(domain.cells.size());
+        LocalVector b(domain.cells.size());
+        bool converged = false;
+        try {
+            for (int iterIdx = 0; ; ++iterIdx) {
+                updateIntensiveQuantities_(domain, elemCtx);
+                linearizer.linearizeDomain(domain);
+                converged = error_(domain, residual) <= tolerance;
+                if (converged || iterIdx >= maxLocalIterations_)
+                    break;
+
+                // solve the linearized system of the domain
+                auto blockIt = domain.globalBlocks.begin();
+                for (auto rowIt = domain.matrix.begin(); rowIt != domain.matrix.end(); ++rowIt)
+                    for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt, ++blockIt)
+                        *colIt = **blockIt;
+                for (std::size_t localIdx = 0; localIdx < domain.cells.size(); ++localIdx)
+                    b[localIdx] = residual[domain.cells[localIdx]];
+                x = 0.0;
+
+                Dune::MatrixAdapter<LocalMatrix, LocalVector, LocalVector> op(domain.matrix);
+                Dune::SeqILU<LocalMatrix, LocalVector, LocalVector> preconditioner(domain.matrix, 1.0);
+                Dune::BiCGSTABSolver<LocalVector> linearSolver(op, preconditioner,
+                                                               localLinearSolverReduction,
+                                                               localLinearSolverMaxIterations,
+                                                               /*verbose=*/0);
+                Dune::InverseOperatorResult result;
+                linearSolver.apply(x, b, result);
+                if (!std::isfinite(x.one_norm()))
+                    break;
+
+                // update the primary variables of the domain
+                for (std::size_t localIdx = 0; localIdx < domain.cells.size(); ++localIdx) {
+                    const int globalIdx = domain.cells[localIdx];
+                    currentSolution_[globalIdx] = solution[globalIdx];
+                    update_[globalIdx] = x[localIdx];
+                }
+                updateFn(solution, currentSolution_, update_, residual, domain.cells);
+            }
+        }
+        catch (...) {
+            // exceptions must not escape from the parallel loop over the domains
+            converged = false;
+            for (std::size_t localIdx = 0; localIdx < domain.cells.size(); ++localIdx)
+                solution[domain.cells[localIdx]] = initialSolution[localIdx];
+            updateIntensiveQuantities_(domain, elemCtx);
+        }
+
+        for (int globalIdx : domain.cells)
+            update_[globalIdx] = 0.0;
+
+        return converged;
+    }
+
+    // re-compute the intensive quantities of the cells of a domain
+    void updateIntensiveQuantities_(const Domain& domain, ElementContext& elemCtx)
+    {
+        const auto& model = simulator_.model();
+        const auto& grid = simulator_.gridView().grid();
+        for (int globalIdx : domain.cells) {
+            model.setIntensiveQuantitiesCacheEntryValidity(globalIdx, /*timeIdx=*/0, false);
+            elemCtx.updatePrimaryStencil(grid.entity(cellSeed_[globalIdx]));
+            elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
+        }
+    }
+
+    // the maximum weighted residual of a domain, cf. NewtonMethod::preSolve_()
+    Scalar error_(const Domain& domain, const GlobalEqVector& residual) const
+    {
+        const auto& model = simulator_.model();
+        Scalar error = 0.0;
+        for (int globalIdx : domain.cells) {
+            if (model.dofTotalVolume(globalIdx) <= 0.0)
+                continue;
+
+            const auto& r = residual[globalIdx];
+            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
+                error = std::max(std::abs(r[eqIdx] * model.eqWeight(globalIdx, eqIdx)), error);
+        }
+        return error;
+    }
+
+    Simulator& simulator_;
+    int numDomains_;
+    int maxLocalIterations_;
+
+    std::vector<Domain> domains_;
+    std::vector<std::vector<unsigned>> colorDomains_;
+    std::vector<unsigned> cellDomain_;
+    std::vector<unsigned> cellLocalIdx_;
+    std::vector<ElementSeed> cellSeed_;
+
+    // scratch vectors for updating the primary variables. each domain only writes to
+    // the entries of its own cells.
+    SolutionVector currentSolution_;
+    GlobalEqVector update_;
+
+    const void* lastJacobian_ = nullptr;
+    std::size_t lastNumRows_ = 0;
+};
+
+} // namespace Opm
+
+#endif
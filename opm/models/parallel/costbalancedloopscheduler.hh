@@ -0,0 +1,226 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::CostBalancedLoopScheduler
+ */
+#ifndef EWOMS_COST_BALANCED_LOOP_SCHEDULER_HH
+#define EWOMS_COST_BALANCED_LOOP_SCHEDULER_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Opm {
+
+/*!
+ * \brief Distributes the iterations of a loop with non-uniform costs to the OpenMP
+ *        threads.
+ *
+ * The loop is split into contiguous chunks of roughly equal estimated cost and each
+ * thread is assigned a contiguous range of chunks. The estimate starts from the
+ * a-priori costs passed to setCosts() and is refined after each run() using the
+ * measured execution time of the chunks, so the object should be kept alive and
+ * reused for subsequent executions of the same loop. If the estimate is off, threads
+ * which have finished their own range steal chunks from the other threads.
+ *
+ * ATTENTION: run() must be called from a sequential context!
+ */
+class CostBalancedLoopScheduler
+{
+    // weight of the most recent measurement when updating the cost estimate
+    static constexpr double measurementWeight = 0.5;
+
+    // number of chunks per thread. More chunks improve the granularity of work
+    // stealing at the price of a higher scheduling overhead.
+    static constexpr std::size_t chunksPerThread = 8;
+
+public:
+    /*!
+     * \brief Set the a-priori estimate for the cost of each iteration of the loop.
+     *
+     * Only the relative magnitude of the costs matters. This discards the timings
+     * measured by previous calls to run().
+     */
+    void setCosts(std::vector<double> costs)
+    {
+        cost_ = std::move(costs);
+        haveMeasurements_ = false;
+        numThreads_ = 0;
+    }
+
+    /*!
+     * \brief Returns the number of iterations of the loop.
+     */
+    std::size_t numItems() const
+    { return cost_.size(); }
+
+    /*!
+     * \brief Returns the ratio between the maximum and the average time which the
+     *        threads spent on the loop during the last call to run().
+     */
+    double lastImbalance() const
+    { return lastImbalance_; }
+
+    /*!
+     * \brief Execute the loop.
+     *
+     * \param fn A functor which is called with the index of each iteration
+     *           (i.e., for 0 <= i < numItems()) exactly once.
+     */
+    template <class Functor>
+    void run(Functor&& fn)
+    {
+#ifdef _OPENMP
+        const int numThreads = omp_get_max_threads();
+        if (numThreads != numThreads_)
+            buildChunks_(numThreads);
+
+        std::vector<double> threadTime(numThreads, 0.0);
+        for (int threadIdx = 0; threadIdx < numThreads; ++threadIdx)
+            threadNextChunk_[threadIdx].value = threadChunkStart_[threadIdx];
+
+#pragma omp parallel num_threads(numThreads)
+        {
+            const int myThreadIdx = omp_get_thread_num();
+            const auto runChunks = [&](int ownerIdx) {
+                const std::size_t chunkEnd = threadChunkStart_[ownerIdx + 1];
+                auto& nextChunk = threadNextChunk_[ownerIdx].value;
+                for (std::size_t chunkIdx = nextChunk++; chunkIdx < chunkEnd; chunkIdx = nextChunk++) {
+                    const double startTime = omp_get_wtime();
+                    for (std::size_t itemIdx = chunkStart_[chunkIdx]; itemIdx < chunkStart_[chunkIdx + 1]; ++itemIdx)
+                        fn(itemIdx);
+                    chunkTime_[chunkIdx] = omp_get_wtime() - startTime;
+                    threadTime[myThreadIdx] += chunkTime_[chunkIdx];
+                }
+            };
+
+            // first work on our own chunks, then help the other threads
+            runChunks(myThreadIdx);
+            for (int i = 1; i < numThreads; ++i)
+                runChunks((myThreadIdx + i) % numThreads);
+        }
+
+        const double maxTime = *std::max_element(threadTime.begin(), threadTime.end());
+        double meanTime = 0.0;
+        for (double t : threadTime)
+            meanTime += t;
+        meanTime /= numThreads;
+        lastImbalance_ = (meanTime > 0.0) ? maxTime/meanTime : 1.0;
+
+        updateCosts_();
+        buildChunks_(numThreads);
+#else
+        for (std::size_t itemIdx = 0; itemIdx < cost_.size(); ++itemIdx)
+            fn(itemIdx);
+#endif
+    }
+
+private:
+    // distribute the measured time of each chunk to its items proportionally to their
+    // current cost estimate
+    void updateCosts_()
+    {
+        const std::size_t numChunks = chunkTime_.size();
+        for (std::size_t chunkIdx = 0; chunkIdx < numChunks; ++chunkIdx) {
+            const std::size_t itemBegin = chunkStart_[chunkIdx];
+            const std::size_t itemEnd = chunkStart_[chunkIdx + 1];
+            double estimatedTime = 0.0;
+            for (std::size_t itemIdx = itemBegin; itemIdx < itemEnd; ++itemIdx)
+                estimatedTime += cost_[itemIdx];
+            if (estimatedTime <= 0.0)
+                continue;
+
+            const double scale = chunkTime_[chunkIdx]/estimatedTime;
+            for (std::size_t itemIdx = itemBegin; itemIdx < itemEnd; ++itemIdx) {
+                const double measuredCost = cost_[itemIdx]*scale;
+                if (haveMeasurements_)
+                    cost_[itemIdx] = (1.0 - measurementWeight)*cost_[itemIdx] + measurementWeight*measuredCost;
+                else
+                    cost_[itemIdx] = measuredCost;
+            }
+        }
+        haveMeasurements_ = true;
+    }
+
+    // split the items into chunks of approximately equal cost and assign the same
+    // number of consecutive chunks to each thread
+    void buildChunks_(int numThreads)
+    {
+        numThreads_ = numThreads;
+        const std::size_t numItems = cost_.size();
+        const std::size_t numChunks =
+            std::max<std::size_t>(1, std::min(numItems, numThreads*chunksPerThread));
+
+        double totalCost = 0.0;
+        for (double c : cost_)
+            totalCost += c;
+
+        chunkStart_.assign(1, 0);
+        double accumulatedCost = 0.0;
+        for (std::size_t itemIdx = 0; itemIdx < numItems; ++itemIdx) {
+            accumulatedCost += cost_[itemIdx];
+            const std::size_t numRemainingChunks = numChunks - chunkStart_.size();
+            const std::size_t numRemainingItems = numItems - itemIdx - 1;
+            // close the chunk once its share of the total cost is reached, but leave
+            // at least one item for each of the remaining chunks
+            const double chunkEndCost = totalCost*chunkStart_.size()/numChunks;
+            if (numRemainingChunks > 0 &&
+                (accumulatedCost >= chunkEndCost || numRemainingItems <= numRemainingChunks))
+                chunkStart_.push_back(itemIdx + 1);
+        }
+        chunkStart_.push_back(numItems);
+        chunkTime_.assign(chunkStart_.size() - 1, 0.0);
+
+        const std::size_t actualNumChunks = chunkTime_.size();
+        threadChunkStart_.resize(numThreads + 1);
+        for (int threadIdx = 0; threadIdx <= numThreads; ++threadIdx)
+            threadChunkStart_[threadIdx] = actualNumChunks*threadIdx/numThreads;
+        threadNextChunk_.reset(new PaddedCounter[numThreads]);
+    }
+
+    // the counters of the threads are placed on separate cache lines
+    struct alignas(64) PaddedCounter
+    {
+        std::atomic<std::size_t> value{0};
+    };
+
+    std::vector<double> cost_;
+    std::vector<std::size_t> chunkStart_;
+    std::vector<double> chunkTime_;
+    std::vector<std::size_t> threadChunkStart_;
+    std::unique_ptr<PaddedCounter[]> threadNextChunk_;
+    int numThreads_ = 0;
+    bool haveMeasurements_ = false;
+    double lastImbalance_ = 1.0;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,161 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ElementChunks
+ */
+#ifndef EWOMS_ELEMENT_CHUNKS_HH
+#define EWOMS_ELEMENT_CHUNKS_HH
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Opm {
+
+/*!
+ * \brief Distributes the elements of a grid view to the threads of an OpenMP parallel
+ *        region in chunks.
+ *
+ * In contrast to ThreadedEntityIterator, the elements are collected once into a flat
+ * list which is split into chunks of consecutive elements. The threads grab whole
+ * chunks by incrementing an atomic counter, so no mutex is taken per element. The
+ * list must be rebuilt using update() whenever the grid is modified.
+ *
+ * Usage:
+ * \code
+ * typename ElementChunks<GridView>::Cursor cursor;
+ * #pragma omp parallel
+ * {
+ *     // thread specific objects
+ *     chunks.forEach(cursor, [&](const auto& elem) { ... });
+ * }
+ * \endcode
+ */
+template <class GridView>
+class ElementChunks
+{
+    // the number of chunks per thread. more chunks improve the load balance at the
+    // price of more accesses to the shared counter
+    static constexpr std::size_t chunksPerThread = 16;
+
+    // upper limit of the number of elements per chunk
+    static constexpr std::size_t maxChunkSize = 256;
+
+public:
+    using Element = typename GridView::template Codim<0>::Entity;
+    using ElementSeed = typename Element::EntitySeed;
+
+    /*!
+     * \brief The state of a loop over the chunks which is shared by all threads.
+     *
+     * A new cursor must be created in a sequential context for each loop.
+     */
+    class Cursor
+    {
+        friend class ElementChunks;
+
+    public:
+        /*!
+         * \brief Make the threads stop after they have finished their current chunk.
+         */
+        void setFinished()
+        { nextChunk_ = std::numeric_limits<std::size_t>::max()/2; }
+
+    private:
+        std::atomic<std::size_t> nextChunk_{0};
+    };
+
+    explicit ElementChunks(const GridView& gridView)
+        : gridView_(gridView)
+    { update(); }
+
+    /*!
+     * \brief Collect the elements of the grid view.
+     *
+     * ATTENTION: This method must be called in a sequential context!
+     */
+    void update()
+    {
+        seeds_.clear();
+        seeds_.reserve(gridView_.size(/*codim=*/0));
+        for (const auto& elem : elements(gridView_))
+            seeds_.push_back(elem.seed());
+
+#ifdef _OPENMP
+        const std::size_t numThreads = omp_get_max_threads();
+#else
+        const std::size_t numThreads = 1;
+#endif
+        chunkSize_ = std::clamp<std::size_t>(seeds_.size()/(numThreads*chunksPerThread),
+                                             1, maxChunkSize);
+        numChunks_ = (seeds_.size() + chunkSize_ - 1)/chunkSize_;
+    }
+
+    /*!
+     * \brief Returns the number of elements.
+     */
+    std::size_t size() const
+    { return seeds_.size(); }
+
+    /*!
+     * \brief Call a functor for each element of the chunks which are grabbed by the
+     *        calling thread.
+     *
+     * This is supposed to be called by each thread of a parallel region with the same
+     * cursor. After all threads have returned, the functor was called exactly once
+     * for each element.
+     */
+    template <class Functor>
+    void forEach(Cursor& cursor, Functor&& fn) const
+    {
+        const auto& grid = gridView_.grid();
+        for (std::size_t chunkIdx = cursor.nextChunk_.fetch_add(1, std::memory_order_relaxed);
+             chunkIdx < numChunks_;
+             chunkIdx = cursor.nextChunk_.fetch_add(1, std::memory_order_relaxed))
+        {
+            const std::size_t chunkBegin = chunkIdx*chunkSize_;
+            const std::size_t chunkEnd = std::min(chunkBegin + chunkSize_, seeds_.size());
+            for (std::size_t elemIdx = chunkBegin; elemIdx < chunkEnd; ++elemIdx)
+                fn(grid.entity(seeds_[elemIdx]));
+        }
+    }
+
+private:
+    GridView gridView_;
+    std::vector<ElementSeed> seeds_;
+    std::size_t chunkSize_ = 1;
+    std::size_t numChunks_ = 0;
+};
+
+} // namespace Opm
+
+#endif
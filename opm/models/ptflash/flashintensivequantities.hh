@@ -109,7 +109,7 @@ public:
 
         const Scalar flashTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, FlashTolerance);
         const int flashVerbosity = EWOMS_GET_PARAM(TypeTag, int, FlashVerbosity);
-        const std::string flashTwoPhaseMethod = EWOMS_GET_PARAM(TypeTag, std::string, FlashTwoPhaseMethod);
+        const std::string& flashTwoPhaseMethod = EWOMS_GET_PARAM(TypeTag, std::string, FlashTwoPhaseMethod);
 
         // extract the total molar densities of the components
         ComponentVector z(0.);
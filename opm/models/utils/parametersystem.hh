@@ -41,7 +41,9 @@
 #include <dune/common/classname.hh>
 #include <dune/common/parametertree.hh>
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <set>
 #include <list>
 #include <sstream>
@@ -101,7 +103,9 @@
  *
  * \brief Retrieve a runtime parameter.
  *
- * The default value is specified via the property system.
+ * The default value is specified via the property system. The value is looked up in
+ * the parameter tree only once and stored afterwards, so this may be used in
+ * performance critical code.
  *
  * Example:
  *
@@ -112,8 +116,8 @@
  * \endcode
  */
 #define EWOMS_GET_PARAM(TypeTag, ParamType, ParamName)                         \
-    (::Opm::Parameters::get<TypeTag, ParamType>(#ParamName, #ParamName, \
-                                                getPropValue<TypeTag, Properties::ParamName>()))
+    (::Opm::Parameters::getCached<TypeTag, ParamType, Properties::ParamName>(#ParamName, \
+                                                                              #ParamName))
 
 //!\cond SKIP_THIS
 #define EWOMS_GET_PARAM_(TypeTag, ParamType, ParamName)                 \
@@ -238,9 +242,24 @@ struct ParameterMetaData<TypeTag, TTag::ParameterSystem>
 {
     using type = Dune::ParameterTree;
 
+    /*!
+     * \brief Returns the parameter tree for modification.
+     *
+     * The values stored by Parameters::getCached() are retrieved again afterwards.
+     */
     static Dune::ParameterTree& tree()
+    {
+        ++storage_().generation;
+        return *storage_().tree;
+    }
+
+    static const Dune::ParameterTree& constTree()
     { return *storage_().tree; }
 
+    //! Incremented whenever the parameter tree may have been modified
+    static unsigned generation()
+    { return storage_().generation; }
+
     static std::map<std::string, ::Opm::Parameters::ParamInfo>& mutableRegistry()
     { return storage_().registry; }
 
@@ -259,6 +278,7 @@ struct ParameterMetaData<TypeTag, TTag::ParameterSystem>
         storage_().finalizers.clear();
         storage_().registrationOpen = true;
         storage_().registry.clear();
+        ++storage_().generation;
     }
 
 private:
@@ -277,6 +297,7 @@ private:
         std::map<std::string, ::Opm::Parameters::ParamInfo> registry;
         std::list<std::unique_ptr<::Opm::Parameters::ParamRegFinalizerBase_> > finalizers;
         bool registrationOpen;
+        unsigned generation = 1;
     };
     static Storage_& storage_() {
         static Storage_ obj;
@@ -480,7 +501,7 @@ void printParamList_(std::ostream& os, const std::list<std::string>& keyList, bo
 {
     using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
 
-    const Dune::ParameterTree& tree = ParamsMeta::tree();
+    const Dune::ParameterTree& tree = ParamsMeta::constTree();
 
     auto keyIt = keyList.begin();
     const auto& keyEndIt = keyList.end();
@@ -859,7 +880,7 @@ void printValues(std::ostream& os = std::cout)
 {
     using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
 
-    const Dune::ParameterTree& tree = ParamsMeta::tree();
+    const Dune::ParameterTree& tree = ParamsMeta::constTree();
 
     std::list<std::string> runTimeAllKeyList;
     std::list<std::string> runTimeKeyList;
@@ -927,7 +948,7 @@ bool printUnused(std::ostream& os = std::cout)
 {
     using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
 
-    const Dune::ParameterTree& tree = ParamsMeta::tree();
+    const Dune::ParameterTree& tree = ParamsMeta::constTree();
     std::list<std::string> runTimeAllKeyList;
     std::list<std::string> unknownKeyList;
 
@@ -1008,7 +1029,7 @@ public:
         std::string canonicalName(paramName);
 
         // check whether the parameter is in the parameter tree
-        return ParamsMeta::tree().hasKey(canonicalName);
+        return ParamsMeta::constTree().hasKey(canonicalName);
     }
 
 
@@ -1092,7 +1113,7 @@ private:
         std::string canonicalName(paramName);
 
         // retrieve actual parameter from the parameter tree
-        return ParamsMeta::tree().template get<ParamType>(canonicalName, defaultValue);
+        return ParamsMeta::constTree().template get<ParamType>(canonicalName, defaultValue);
     }
 };
 
@@ -1110,6 +1131,43 @@ const ParamType get(const char *propTagName, const char *paramName, const ParamT
     return Param<TypeTag>::template get<ParamType>(propTagName, paramName, defaultValue, errorIfNotRegistered);
 }
 
+// the value of a parameter retrieved by getCached(). generation is zero if it has not
+// been retrieved yet.
+template <class TypeTag, class ParamType, template<class, class> class Property>
+struct CachedParam_
+{
+    static inline std::mutex mutex;
+    static inline std::atomic<unsigned> generation{0};
+    static inline ParamType value;
+};
+
+/*!
+ * \brief Retrieve a parameter and store its value for subsequent calls.
+ *
+ * The value is specific for the type tag, the type and the property of the
+ * parameter. It is retrieved again if the parameter tree has been modified since the
+ * last call.
+ */
+template <class TypeTag, class ParamType, template<class, class> class Property>
+const ParamType& getCached(const char *propTagName, const char *paramName)
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+    using Cache = CachedParam_<TypeTag, ParamType, Property>;
+
+    const unsigned generation = ParamsMeta::generation();
+    if (Cache::generation.load(std::memory_order_acquire) != generation) {
+        std::lock_guard<std::mutex> lock(Cache::mutex);
+        if (Cache::generation.load(std::memory_order_relaxed) != generation) {
+            Cache::value = get<TypeTag, ParamType>(propTagName,
+                                                   paramName,
+                                                   getPropValue<TypeTag, Property>());
+            Cache::generation.store(generation, std::memory_order_release);
+        }
+    }
+
+    return Cache::value;
+}
+
 template <class TypeTag, class Container>
 void getLists(Container& usedParams, Container& unusedParams)
 {
@@ -1123,7 +1181,7 @@ void getLists(Container& usedParams, Container& unusedParams)
 
     // get all parameter keys
     std::list<std::string> allKeysList;
-    const auto& paramTree = ParamsMeta::tree();
+    const auto& paramTree = ParamsMeta::constTree();
     getFlattenedKeyList_(allKeysList, paramTree);
 
     for (const auto& key : allKeysList) {
@@ -0,0 +1,201 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::CsrSparsityPattern
+ */
+#ifndef EWOMS_CSR_SPARSITY_PATTERN_HH
+#define EWOMS_CSR_SPARSITY_PATTERN_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ * \brief The sparsity pattern of a matrix in compressed row storage.
+ *
+ * The column indices of each row are sorted and unique. The pattern is created from
+ * lists of (row, column) pairs which may contain duplicates, e.g., one list per thread
+ * which traversed a part of the grid. Compared to one std::set per row, this avoids
+ * allocating a tree node per non-zero entry and the expensive parts are OpenMP
+ * parallelized.
+ */
+class CsrSparsityPattern
+{
+public:
+    using Index = unsigned;
+    using Connection = std::pair<Index, Index>;
+
+    /*!
+     * \brief Returns the number of rows of the pattern.
+     */
+    std::size_t size() const
+    { return rowStart_.empty() ? 0 : rowStart_.size() - 1; }
+
+    /*!
+     * \brief Returns the number of non-zero entries of the pattern.
+     */
+    std::size_t numNonZeros() const
+    { return columnIndices_.size(); }
+
+    /*!
+     * \brief Returns the number of non-zero entries of a row.
+     */
+    std::size_t rowSize(std::size_t rowIdx) const
+    { return rowStart_[rowIdx + 1] - rowStart_[rowIdx]; }
+
+    /*!
+     * \brief Returns a pointer to the sorted column indices of a row.
+     */
+    const Index* rowBegin(std::size_t rowIdx) const
+    { return columnIndices_.data() + rowStart_[rowIdx]; }
+
+    /*!
+     * \brief Returns a pointer after the last column index of a row.
+     */
+    const Index* rowEnd(std::size_t rowIdx) const
+    { return columnIndices_.data() + rowStart_[rowIdx + 1]; }
+
+    /*!
+     * \brief Replace the pattern by the union of a number of connection lists.
+     *
+     * \param numRows The number of rows of the pattern
+     * \param connectionLists The (row, column) pairs of all non-zero entries
+     */
+    void assign(std::size_t numRows, const std::vector<std::vector<Connection>>& connectionLists)
+    {
+        // count the connections of each row (including duplicates)
+        std::unique_ptr<std::atomic<std::size_t>[]> rowCursor(new std::atomic<std::size_t>[numRows + 1]);
+        for (std::size_t rowIdx = 0; rowIdx <= numRows; ++rowIdx)
+            rowCursor[rowIdx] = 0;
+        for (const auto& connections : connectionLists) {
+            const long numConnections = static_cast<long>(connections.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (long i = 0; i < numConnections; ++i) {
+                assert(connections[i].first < numRows);
+                rowCursor[connections[i].first + 1].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        // prefix sum. afterwards, rowCursor[i] points to the first unused entry of row i
+        std::vector<std::size_t> rawRowStart(numRows + 1, 0);
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            rawRowStart[rowIdx + 1] = rawRowStart[rowIdx] + rowCursor[rowIdx + 1];
+            rowCursor[rowIdx] = rawRowStart[rowIdx];
+        }
+
+        // fill the rows
+        std::vector<Index> rawColumnIndices(rawRowStart[numRows]);
+        for (const auto& connections : connectionLists) {
+            const long numConnections = static_cast<long>(connections.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (long i = 0; i < numConnections; ++i) {
+                const std::size_t pos = rowCursor[connections[i].first].fetch_add(1, std::memory_order_relaxed);
+                rawColumnIndices[pos] = connections[i].second;
+            }
+        }
+
+        compress_(numRows, rawRowStart, rawColumnIndices);
+    }
+
+    /*!
+     * \brief Add the entries specified by one set of column indices per row.
+     *
+     * This is used to add the connections of auxiliary modules which work on a
+     * std::vector<std::set<unsigned>>.
+     */
+    template <class Set>
+    void merge(const std::vector<Set>& additionalColumns)
+    {
+        assert(additionalColumns.size() == size());
+        const std::size_t numRows = size();
+        std::vector<std::size_t> rawRowStart(numRows + 1, 0);
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            rawRowStart[rowIdx + 1] = rawRowStart[rowIdx] + rowSize(rowIdx) + additionalColumns[rowIdx].size();
+
+        std::vector<Index> rawColumnIndices(rawRowStart[numRows]);
+        const long numRowsLong = static_cast<long>(numRows);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < numRowsLong; ++rowIdx) {
+            auto outIt = std::copy(rowBegin(rowIdx), rowEnd(rowIdx),
+                                   rawColumnIndices.begin() + rawRowStart[rowIdx]);
+            std::copy(additionalColumns[rowIdx].begin(), additionalColumns[rowIdx].end(), outIt);
+        }
+
+        compress_(numRows, rawRowStart, rawColumnIndices);
+    }
+
+private:
+    // sort the rows of a raw pattern, remove the duplicate entries and store the result
+    void compress_(std::size_t numRows,
+                   const std::vector<std::size_t>& rawRowStart,
+                   std::vector<Index>& rawColumnIndices)
+    {
+        std::vector<std::size_t> uniqueRowSize(numRows);
+        const long numRowsLong = static_cast<long>(numRows);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1024)
+#endif
+        for (long rowIdx = 0; rowIdx < numRowsLong; ++rowIdx) {
+            const auto rowBeginIt = rawColumnIndices.begin() + rawRowStart[rowIdx];
+            const auto rowEndIt = rawColumnIndices.begin() + rawRowStart[rowIdx + 1];
+            std::sort(rowBeginIt, rowEndIt);
+            uniqueRowSize[rowIdx] = std::unique(rowBeginIt, rowEndIt) - rowBeginIt;
+        }
+
+        rowStart_.resize(numRows + 1);
+        rowStart_[0] = 0;
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            rowStart_[rowIdx + 1] = rowStart_[rowIdx] + uniqueRowSize[rowIdx];
+
+        columnIndices_.resize(rowStart_[numRows]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < numRowsLong; ++rowIdx)
+            std::copy_n(rawColumnIndices.begin() + rawRowStart[rowIdx],
+                        uniqueRowSize[rowIdx],
+                        columnIndices_.begin() + rowStart_[rowIdx]);
+    }
+
+    std::vector<std::size_t> rowStart_;
+    std::vector<Index> columnIndices_;
+};
+
+}} // namespace Linear, Opm
+
+#endif
@@ -75,10 +75,9 @@ namespace Opm::Linear {
         template <class LinearOperator, class ScalarProduct, class Preconditioner> \
         std::shared_ptr<RawSolver> get(LinearOperator& parOperator,                \
                                        ScalarProduct& parScalarProduct,            \
-                                       Preconditioner& parPreCond)                 \
+                                       Preconditioner& parPreCond,                 \
+                                       Scalar tolerance)                           \
         {                                                                          \
-            Scalar tolerance = EWOMS_GET_PARAM(TypeTag, Scalar,                    \
-                                               LinearSolverTolerance);             \
             int maxIter = EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations);\
                                                                                    \
             int verbosity = 0;                                                     \
@@ -131,9 +130,9 @@ public:
     template <class LinearOperator, class ScalarProduct, class Preconditioner>
     std::shared_ptr<RawSolver> get(LinearOperator& parOperator,
                                    ScalarProduct& parScalarProduct,
-                                   Preconditioner& parPreCond)
+                                   Preconditioner& parPreCond,
+                                   Scalar tolerance)
     {
-        Scalar tolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance);
         int maxIter = EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxIterations);
 
         int verbosity = 0;
@@ -46,6 +46,32 @@ struct PreconditionerWrapper { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverScalar { using type = UndefinedProperty; };
 
+/*!
+ * \brief The floating point type used for the entries of the Jacobian matrix.
+ *
+ * The linearizer writes the partial derivatives directly into blocks of this type.
+ * Using a type of lower precision than LinearSolverScalar (e.g., float matrices and
+ * double vectors) halves the memory traffic of the matrix-vector products and of the
+ * setup of the preconditioner.
+ */
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverMatrixScalar { using type = UndefinedProperty; };
+
+/*!
+ * \brief The maximum number of restarts of the linear solver.
+ *
+ * If the linear solver did not achieve the requested residual reduction, the
+ * residual is re-computed using the current solution and the linear solver is
+ * restarted to compute a correction. This recovers from the stagnation of the Krylov
+ * method and from the accumulation of rounding errors in its recursively updated
+ * residual. The defect is computed with the same matrix the solver uses, so this is
+ * not an iterative refinement and does not compensate for the precision lost by
+ * storing the matrix as LinearSolverMatrixScalar. Restarts require a copy of the right
+ * hand side and are thus disabled by default.
+ */
+template<class TypeTag, class MyTypeTag>
+struct LinearSolverMaxRefinementSteps { using type = UndefinedProperty; };
+
 /*!
  * \brief The size of the algebraic overlap of the linear solver.
  *
@@ -163,6 +163,10 @@ protected:
 
     std::shared_ptr<AMG> preparePreconditioner_()
     {
+        // the hierarchy is still valid for the current matrix
+        if (amg_)
+            return amg_;
+
 #if HAVE_MPI
         // create and initialize DUNE's OwnerOverlapCopyCommunication
         // using the domestic overlap
@@ -184,7 +188,10 @@ protected:
     }
 
     void cleanupPreconditioner_()
-    { /* nothing to do */ }
+    {
+        amg_.reset();
+        fineOperator_.reset();
+    }
 
     std::shared_ptr<RawLinearSolver> prepareSolver_(ParallelOperator& parOperator,
                                                     ParallelScalarProduct& parScalarProduct,
@@ -193,7 +200,7 @@ protected:
         const auto& gridView = this->simulator_.gridView();
         using CCC = CombinedCriterion<OverlappingVector, decltype(gridView.comm())>;
 
-        Scalar linearSolverTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance);
+        Scalar linearSolverTolerance = this->residualReductionTolerance();
         Scalar linearSolverAbsTolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverAbsTolerance);
         if(linearSolverAbsTolerance < 0.0)
             linearSolverAbsTolerance = this->simulator_.model().newtonMethod().tolerance()/100.0;
@@ -49,6 +49,7 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <algorithm>
 #include <sstream>
 #include <memory>
 #include <iostream>
@@ -65,9 +66,9 @@ template<class TypeTag>
 struct SparseMatrixAdapter<TypeTag, TTag::ParallelBaseLinearSolver>
 {
 private:
-    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using MatrixScalar = GetPropType<TypeTag, Properties::LinearSolverMatrixScalar>;
     enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
-    using Block = Opm::MatrixBlock<Scalar, numEq, numEq>;
+    using Block = Opm::MatrixBlock<MatrixScalar, numEq, numEq>;
 
 public:
     using type = typename Opm::Linear::IstlSparseMatrixAdapter<Block>;
@@ -145,7 +146,11 @@ public:
     }
 
     ~ParallelBaseBackend()
-    { cleanup_(); }
+    {
+        // the derived class is already destroyed at this point
+        ParallelBaseBackend::cleanupPreconditioner_();
+        cleanup_();
+    }
 
     /*!
      * \brief Register all run-time parameters for the linear solver.
@@ -162,6 +167,9 @@ public:
                              "The maximum number of iterations of the linear solver");
         EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverVerbosity,
                              "The verbosity level of the linear solver");
+        EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverMaxRefinementSteps,
+                             "The maximum number of times the linear solver is restarted "
+                             "using the re-computed residual if it did not converge");
 
         PreconditionerWrapper::registerParameters();
     }
@@ -171,7 +179,10 @@ public:
      *        equations the next time it is called.
      */
     void eraseMatrix()
-    { cleanup_(); }
+    {
+        asImp_().cleanupPreconditioner_();
+        cleanup_();
+    }
 
     /*!
      * \brief Set up the internal data structures required for the linear solver.
@@ -188,6 +199,7 @@ public:
             // there's noting to do
             return;
 
+        asImp_().cleanupPreconditioner_();
         asImp_().cleanup_();
         gridSequenceNumber_ = curSeqNum;
 
@@ -236,10 +248,14 @@ public:
      * \brief Sets the values of the residual's Jacobian matrix.
      *
      * This method also synchronizes the data structure across the processes which are
-     * involved in the simulation run.
+     * involved in the simulation run. The preconditioner is set up again by the next
+     * call to solve(). If this method is not called between two calls of solve(), the
+     * matrix and the preconditioner of the first call are reused.
      */
     void setMatrix(const SparseMatrixAdapter& M)
     {
+        asImp_().cleanupPreconditioner_();
+
         overlappingMatrix_->assignFromNative(M.istlMatrix());
         overlappingMatrix_->syncAdd();
     }
@@ -254,9 +270,7 @@ public:
         (*overlappingx_) = 0.0;
 
         auto parPreCond = asImp_().preparePreconditioner_();
-        auto precondCleanupFn = [this]() -> void
-                                { this->asImp_().cleanupPreconditioner_(); };
-        auto precondCleanupGuard = Opm::make_guard(precondCleanupFn);
+
         // create the parallel scalar product and the parallel operator
         ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap());
         ParallelOperator parOperator(*overlappingMatrix_);
@@ -271,11 +285,38 @@ public:
             { this->asImp_().cleanupSolver_(); };
         GenericGuard<decltype(cleanupSolverFn)> solverGuard(cleanupSolverFn);
 
+        // the linear solver overwrites the right hand side with the defect, so the
+        // original one must be kept if restarts are enabled
+        const int maxRefinementSteps = EWOMS_GET_PARAM(TypeTag, int, LinearSolverMaxRefinementSteps);
+        std::unique_ptr<OverlappingVector> rhs;
+        if (maxRefinementSteps > 0)
+            rhs = std::make_unique<OverlappingVector>(*overlappingb_);
+
         // run the linear solver and have some fun
         auto result = asImp_().runSolver_(solver);
         // store number of iterations used
         lastIterations_ = result.second;
 
+        // restarts: if the requested residual reduction was not achieved, re-compute the
+        // residual of the current solution and solve for a correction. the defect uses
+        // the same matrix as the solver, so this is not an iterative refinement.
+        if (!result.first && rhs) {
+            OverlappingVector solution(*overlappingx_);
+            for (int stepIdx = 0; !result.first && stepIdx < maxRefinementSteps; ++stepIdx) {
+                // b := b - A x. The solver keeps a reference to overlappingb_
+                *overlappingb_ = *rhs;
+                parOperator.applyscaleadd(-1.0, solution, *overlappingb_);
+                (*overlappingx_) = 0.0;
+
+                result = asImp_().runSolver_(solver);
+                lastIterations_ += result.second;
+                solution += *overlappingx_;
+            }
+
+            *overlappingb_ = *rhs;
+            *overlappingx_ = solution;
+        }
+
         // copy the result back to the non-overlapping vector
         overlappingx_->assignTo(x);
 
@@ -289,6 +330,27 @@ public:
     size_t iterations () const
     { return lastIterations_; }
 
+    /*!
+     * \brief Set the relative residual reduction which the linear solver needs to
+     *        achieve in the next calls to solve().
+     *
+     * This is used by the non-linear solver to solve the linear systems only as accurate
+     * as necessary. The tolerance is never tighter than the LinearSolverTolerance
+     * parameter. A non-positive value restores the latter.
+     */
+    void setResidualReductionTolerance(Scalar tolerance)
+    { residReductionTolerance_ = tolerance; }
+
+    /*!
+     * \brief Returns the relative residual reduction which the linear solver needs to
+     *        achieve.
+     */
+    Scalar residualReductionTolerance() const
+    {
+        Scalar tolerance = EWOMS_GET_PARAM(TypeTag, Scalar, LinearSolverTolerance);
+        return std::max(tolerance, residReductionTolerance_);
+    }
+
 protected:
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -310,10 +372,16 @@ protected:
 
     std::shared_ptr<ParallelPreconditioner> preparePreconditioner_()
     {
+        // the preconditioner is still valid for the current matrix
+        if (preconditionerIsPrepared_)
+            return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+
         int preconditionerIsReady = 1;
+        bool preconditionerCreated = false;
         try {
             // update sequential preconditioner
             precWrapper_.prepare(*overlappingMatrix_);
+            preconditionerCreated = true;
         }
         catch (const Dune::Exception& e) {
             std::cout << "Preconditioner threw exception \"" << e.what()
@@ -325,8 +393,14 @@ protected:
         // make sure that the preconditioner is also ready on all peer
         // ranks.
         preconditionerIsReady = simulator_.gridView().comm().min(preconditionerIsReady);
-        if (!preconditionerIsReady)
+        if (!preconditionerIsReady) {
+            // the preconditioner of the ranks on which the setup succeeded is not
+            // used anymore
+            if (preconditionerCreated)
+                precWrapper_.cleanup();
             throw NumericalProblem("Creating the preconditioner failed");
+        }
+        preconditionerIsPrepared_ = true;
 
         // create the parallel preconditioner
         return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
@@ -334,7 +408,9 @@ protected:
 
     void cleanupPreconditioner_()
     {
-        precWrapper_.cleanup();
+        if (preconditionerIsPrepared_)
+            precWrapper_.cleanup();
+        preconditionerIsPrepared_ = false;
     }
 
     void writeOverlapToVTK_()
@@ -377,12 +453,14 @@ protected:
     const Simulator& simulator_;
     int gridSequenceNumber_;
     size_t lastIterations_;
+    Scalar residReductionTolerance_ = 0.0;
 
     OverlappingMatrix *overlappingMatrix_;
     OverlappingVector *overlappingb_;
     OverlappingVector *overlappingx_;
 
     PreconditionerWrapper precWrapper_;
+    bool preconditionerIsPrepared_ = false;
 };
 }} // namespace Linear, Opm
 
@@ -410,13 +488,22 @@ template<class TypeTag>
 struct LinearSolverScalar<TypeTag, TTag::ParallelBaseLinearSolver>
 { using type = GetPropType<TypeTag, Properties::Scalar>; };
 
+//! by default, the entries of the Jacobian matrix use the precision of the linear solver
+template<class TypeTag>
+struct LinearSolverMatrixScalar<TypeTag, TTag::ParallelBaseLinearSolver>
+{ using type = GetPropType<TypeTag, Properties::LinearSolverScalar>; };
+
+//! do not restart the linear solver if it does not converge by default
+template<class TypeTag>
+struct LinearSolverMaxRefinementSteps<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 0; };
+
 template<class TypeTag>
 struct OverlappingMatrix<TypeTag, TTag::ParallelBaseLinearSolver>
 {
 private:
     static constexpr int numEq = getPropValue<TypeTag, Properties::NumEq>();
-    using LinearSolverScalar = GetPropType<TypeTag, Properties::LinearSolverScalar>;
-    using MatrixBlock = Opm::MatrixBlock<LinearSolverScalar, numEq, numEq>;
+    using MatrixScalar = GetPropType<TypeTag, Properties::LinearSolverMatrixScalar>;
+    using MatrixBlock = Opm::MatrixBlock<MatrixScalar, numEq, numEq>;
     using NonOverlappingMatrix = Dune::BCRSMatrix<MatrixBlock>;
 
 public:
@@ -122,7 +122,8 @@ protected:
     {
         return solverWrapper_.get(parOperator,
                                   parScalarProduct,
-                                  parPreCond);
+                                  parPreCond,
+                                  this->residualReductionTolerance());
     }
 
     void cleanupSolver_()
@@ -94,6 +94,15 @@ public:
     void setMatrix(const SparseMatrixAdapter& M)
     { M_ = &M; }
 
+    /*!
+     * \brief Set the relative residual reduction which the linear solver needs to
+     *        achieve.
+     *
+     * SuperLU is a direct solver, so this is a no-op.
+     */
+    void setResidualReductionTolerance(Scalar)
+    { }
+
     bool solve(Vector& x)
     { return SuperLUSolve_<Scalar, TypeTag, Matrix, Vector>::solve_(*M_, x, *b_); }
 
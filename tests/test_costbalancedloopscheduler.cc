@@ -0,0 +1,133 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests that the CostBalancedLoopScheduler executes each iteration of a loop
+ *        exactly once and produces the same result as a sequential loop.
+ */
+#include "config.h"
+
+#include <opm/models/parallel/costbalancedloopscheduler.hh>
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "unittestutils.hh"
+
+using Opm::Test::check;
+
+// some work whose cost grows with the index of the iteration
+double work(std::size_t itemIdx)
+{
+    double result = 0.0;
+    for (std::size_t i = 0; i < 10*(itemIdx % 97); ++i)
+        result += std::sin(double(i + itemIdx));
+    return result;
+}
+
+// run the loop and check that every iteration is executed exactly once and that the
+// results match the ones of a plain sequential loop
+void runAndCheck(Opm::CostBalancedLoopScheduler& scheduler)
+{
+    const std::size_t numItems = scheduler.numItems();
+    std::unique_ptr<std::atomic<unsigned>[]> numCalls(new std::atomic<unsigned>[numItems]);
+    for (std::size_t i = 0; i < numItems; ++i)
+        numCalls[i] = 0;
+
+    // the loop body runs in a parallel region which exceptions must not leave, so the
+    // failures are only counted there
+    std::atomic<unsigned> numOutOfRange(0);
+    std::vector<double> result(numItems, 0.0);
+    scheduler.run([&](std::size_t itemIdx) {
+        if (itemIdx >= numItems) {
+            ++numOutOfRange;
+            return;
+        }
+        ++numCalls[itemIdx];
+        result[itemIdx] = work(itemIdx);
+    });
+    check(numOutOfRange == 0, std::to_string(numOutOfRange) + " iteration indices were out of range");
+
+    for (std::size_t i = 0; i < numItems; ++i) {
+        check(numCalls[i] == 1, "iteration " + std::to_string(i) + " was executed "
+              + std::to_string(numCalls[i]) + " times");
+        check(result[i] == work(i), "result differs from the sequential loop");
+    }
+    check(scheduler.lastImbalance() >= 1.0, "the imbalance must be at least one");
+}
+
+void testCosts(std::vector<double> costs)
+{
+    Opm::CostBalancedLoopScheduler scheduler;
+    scheduler.setCosts(std::move(costs));
+
+    // the chunks are rebuilt from the measurements after each run, so the partition
+    // must also be valid for the subsequent runs
+    for (int i = 0; i < 4; ++i)
+        runAndCheck(scheduler);
+
+#ifdef _OPENMP
+    // changing the number of threads rebuilds the chunks
+    const int maxThreads = omp_get_max_threads();
+    for (int numThreads : {1, 3, 2*maxThreads + 1}) {
+        omp_set_num_threads(numThreads);
+        runAndCheck(scheduler);
+    }
+    omp_set_num_threads(maxThreads);
+#endif
+}
+
+int main()
+{
+    return Opm::Test::run("test_costbalancedloopscheduler", [&]() {
+        // uniform costs
+        testCosts(std::vector<double>(1000, 1.0));
+
+        // strongly non-uniform costs, including iterations without any cost
+        std::vector<double> costs(1000, 0.0);
+        for (std::size_t i = 0; i < costs.size(); ++i)
+            costs[i] = (i % 10 == 0) ? 100.0 : (i % 3 == 0 ? 0.0 : 1.0);
+        testCosts(costs);
+
+        // all the cost is in the last iteration
+        std::vector<double> lastCosts(500, 0.0);
+        lastCosts.back() = 1.0;
+        testCosts(lastCosts);
+
+        // fewer iterations than threads and an empty loop
+        testCosts(std::vector<double>(3, 1.0));
+        testCosts(std::vector<double>(1, 1.0));
+        testCosts(std::vector<double>());
+
+        // an estimate which is completely zero
+        testCosts(std::vector<double>(100, 0.0));
+    });
+}
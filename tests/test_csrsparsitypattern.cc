@@ -0,0 +1,167 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests the CsrSparsityPattern and the matrices which IstlSparseMatrixAdapter
+ *        allocates from it against patterns which use one std::set per row.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/csrsparsitypattern.hh>
+#include <opm/simulators/linalg/istlsparsematrixadapter.hh>
+
+#include <dune/common/fmatrix.hh>
+
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "unittestutils.hh"
+
+using Pattern = Opm::Linear::CsrSparsityPattern;
+using Connection = Pattern::Connection;
+using SetPattern = std::vector<std::set<unsigned>>;
+
+using Opm::Test::check;
+
+// random connection lists which contain duplicates, both within a list and across
+// lists. some rows stay empty.
+std::vector<std::vector<Connection>> randomConnections(unsigned numRows,
+                                                       unsigned numLists,
+                                                       unsigned numConnectionsPerList)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<unsigned> rowDist(0, numRows - 1);
+    std::uniform_int_distribution<unsigned> offsetDist(0, 6);
+
+    std::vector<std::vector<Connection>> lists(numLists);
+    for (auto& connections : lists) {
+        for (unsigned i = 0; i < numConnectionsPerList; ++i) {
+            const unsigned rowIdx = rowDist(rng);
+            if (rowIdx % 17 == 0)
+                continue;
+            const unsigned colIdx = std::min(numRows - 1, rowIdx + offsetDist(rng));
+            connections.emplace_back(rowIdx, colIdx);
+            connections.emplace_back(rowIdx, rowIdx);
+        }
+    }
+    return lists;
+}
+
+void checkEqual(const Pattern& pattern, const SetPattern& reference)
+{
+    check(pattern.size() == reference.size(), "the pattern has the wrong number of rows");
+
+    std::size_t numNonZeros = 0;
+    for (std::size_t rowIdx = 0; rowIdx < reference.size(); ++rowIdx) {
+        const std::vector<unsigned> row(pattern.rowBegin(rowIdx), pattern.rowEnd(rowIdx));
+        const std::vector<unsigned> refRow(reference[rowIdx].begin(), reference[rowIdx].end());
+        check(pattern.rowSize(rowIdx) == refRow.size(), "row " + std::to_string(rowIdx) + " has the wrong size");
+        check(row == refRow, "row " + std::to_string(rowIdx) + " has the wrong column indices");
+        numNonZeros += refRow.size();
+    }
+    check(pattern.numNonZeros() == numNonZeros, "wrong number of non-zero entries");
+}
+
+void testPattern()
+{
+    const unsigned numRows = 1000;
+    const auto lists = randomConnections(numRows, /*numLists=*/4, /*numConnectionsPerList=*/3000);
+
+    SetPattern reference(numRows);
+    for (const auto& connections : lists)
+        for (const auto& [rowIdx, colIdx] : connections)
+            reference[rowIdx].insert(colIdx);
+
+    Pattern pattern;
+    pattern.assign(numRows, lists);
+    checkEqual(pattern, reference);
+
+    // merging additional columns, some of which are already part of the pattern
+    SetPattern additional(numRows);
+    for (unsigned rowIdx = 0; rowIdx < numRows; rowIdx += 3) {
+        additional[rowIdx].insert(rowIdx);
+        additional[rowIdx].insert((rowIdx*7) % numRows);
+    }
+    pattern.merge(additional);
+    for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        reference[rowIdx].insert(additional[rowIdx].begin(), additional[rowIdx].end());
+    checkEqual(pattern, reference);
+
+    // assigning replaces the previous pattern
+    pattern.assign(numRows, {});
+    checkEqual(pattern, SetPattern(numRows));
+    pattern.assign(0, {});
+    check(pattern.size() == 0 && pattern.numNonZeros() == 0, "the pattern is not empty");
+}
+
+// the matrix allocated from a CsrSparsityPattern must be identical to the one allocated
+// from the equivalent vector of sets
+void testMatrixAdapter()
+{
+    using Block = Dune::FieldMatrix<double, 2, 2>;
+    using Matrix = Opm::Linear::IstlSparseMatrixAdapter<Block>;
+
+    const unsigned numRows = 500;
+    const auto lists = randomConnections(numRows, /*numLists=*/3, /*numConnectionsPerList=*/1500);
+
+    SetPattern setPattern(numRows);
+    for (const auto& connections : lists)
+        for (const auto& [rowIdx, colIdx] : connections)
+            setPattern[rowIdx].insert(colIdx);
+    Pattern csrPattern;
+    csrPattern.assign(numRows, lists);
+
+    Matrix setMatrix(numRows, numRows);
+    setMatrix.reserve(setPattern);
+    Matrix csrMatrix(numRows, numRows);
+    csrMatrix.reserve(csrPattern);
+
+    const auto& A = setMatrix.istlMatrix();
+    const auto& B = csrMatrix.istlMatrix();
+    check(A.N() == B.N() && A.M() == B.M(), "the matrices have different dimensions");
+    check(A.nonzeroes() == B.nonzeroes(), "the matrices have a different number of non-zeros");
+    for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        check(A[rowIdx].size() == B[rowIdx].size(), "row " + std::to_string(rowIdx) + " has a different size");
+        auto aIt = A[rowIdx].begin();
+        auto bIt = B[rowIdx].begin();
+        for (; aIt != A[rowIdx].end(); ++aIt, ++bIt)
+            check(aIt.index() == bIt.index(), "row " + std::to_string(rowIdx) + " has different column indices");
+    }
+
+    // the matrix must be usable
+    csrMatrix.clear();
+    for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        csrMatrix.istlMatrix()[rowIdx][rowIdx] = 1.0;
+}
+
+int main()
+{
+    return Opm::Test::run("test_csrsparsitypattern", [&]() {
+        testPattern();
+        testMatrixAdapter();
+    });
+}
@@ -0,0 +1,241 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests the locality-improving orderings of the degrees of freedom and the
+ *        ReorderedMapper.
+ */
+#include "config.h"
+
+#include <opm/models/discretization/common/reorderedmapper.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "unittestutils.hh"
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct DofOrderingTest { using InheritsFrom = std::tuple<ParameterSystem>; };
+}
+
+template<class TypeTag>
+struct GridView<TypeTag, TTag::DofOrderingTest> { using type = Dune::YaspGrid<2>::LeafGridView; };
+
+template<class TypeTag>
+struct DofOrdering<TypeTag, TTag::DofOrderingTest> { static constexpr auto value = "natural"; };
+
+} // namespace Opm::Properties
+
+using TypeTag = Opm::Properties::TTag::DofOrderingTest;
+using Graph = std::vector<std::vector<unsigned>>;
+
+using Opm::Test::check;
+
+void checkPermutation(const std::vector<unsigned>& order, std::size_t size)
+{
+    check(order.size() == size, "ordering has the wrong size");
+    std::vector<unsigned> sorted(order);
+    std::sort(sorted.begin(), sorted.end());
+    for (unsigned i = 0; i < size; ++i)
+        check(sorted[i] == i, "ordering is not a permutation");
+}
+
+// the connectivity graph of a structured nx x ny grid whose vertices were shuffled
+Graph shuffledGridGraph(unsigned nx, unsigned ny)
+{
+    std::vector<unsigned> label(nx*ny);
+    std::iota(label.begin(), label.end(), 0);
+    std::mt19937 rng(1234);
+    std::shuffle(label.begin(), label.end(), rng);
+
+    Graph graph(nx*ny);
+    for (unsigned j = 0; j < ny; ++j) {
+        for (unsigned i = 0; i < nx; ++i) {
+            const unsigned v = label[j*nx + i];
+            if (i > 0)
+                graph[v].push_back(label[j*nx + i - 1]);
+            if (i + 1 < nx)
+                graph[v].push_back(label[j*nx + i + 1]);
+            if (j > 0)
+                graph[v].push_back(label[(j - 1)*nx + i]);
+            if (j + 1 < ny)
+                graph[v].push_back(label[(j + 1)*nx + i]);
+        }
+    }
+    return graph;
+}
+
+// the maximum distance of the new indices of two coupled vertices
+unsigned bandwidth(const Graph& graph, const std::vector<unsigned>& order)
+{
+    std::vector<unsigned> newIndex(order.size());
+    for (unsigned i = 0; i < order.size(); ++i)
+        newIndex[order[i]] = i;
+
+    unsigned result = 0;
+    for (unsigned v = 0; v < graph.size(); ++v)
+        for (unsigned w : graph[v])
+            result = std::max(result, newIndex[v] > newIndex[w]
+                                      ? newIndex[v] - newIndex[w]
+                                      : newIndex[w] - newIndex[v]);
+    return result;
+}
+
+void testReverseCuthillMcKee()
+{
+    const unsigned nx = 10;
+    const unsigned ny = 10;
+    const Graph graph = shuffledGridGraph(nx, ny);
+
+    std::vector<unsigned> naturalOrder(graph.size());
+    std::iota(naturalOrder.begin(), naturalOrder.end(), 0);
+    const std::vector<unsigned> order = Opm::reverseCuthillMcKeeOrder(graph);
+    checkPermutation(order, graph.size());
+
+    // the level sets of a breadth first search through the grid are its diagonals,
+    // which contain at most nx vertices each. coupled vertices are in the same or in
+    // adjacent level sets.
+    check(bandwidth(graph, order) <= 2*nx, "RCM ordering does not reduce the bandwidth");
+    check(bandwidth(graph, order) < bandwidth(graph, naturalOrder),
+          "RCM ordering is worse than the shuffled ordering");
+
+    // all connected components must be numbered, including isolated vertices
+    Graph disconnected(5);
+    disconnected[0] = {1};
+    disconnected[1] = {0};
+    disconnected[3] = {4};
+    disconnected[4] = {3};
+    checkPermutation(Opm::reverseCuthillMcKeeOrder(disconnected), disconnected.size());
+    checkPermutation(Opm::reverseCuthillMcKeeOrder(Graph()), 0);
+}
+
+void testMorton()
+{
+    using Position = Dune::FieldVector<double, 2>;
+
+    // the four corners of a square are visited along a 'Z' in which the first
+    // coordinate is the most significant one
+    const std::vector<Position> corners = { {1.0, 1.0}, {0.0, 1.0}, {1.0, 0.0}, {0.0, 0.0} };
+    const std::vector<unsigned> order = Opm::mortonOrder(corners);
+    checkPermutation(order, corners.size());
+    check(order == std::vector<unsigned>({3, 1, 2, 0}), "unexpected Morton order of the corners");
+
+    // the points of each quadrant of a regular lattice are numbered contiguously
+    const unsigned n = 8;
+    std::vector<Position> lattice;
+    for (unsigned j = 0; j < n; ++j)
+        for (unsigned i = 0; i < n; ++i)
+            lattice.push_back(Position({double(i), double(j)}));
+    const std::vector<unsigned> latticeOrder = Opm::mortonOrder(lattice);
+    checkPermutation(latticeOrder, lattice.size());
+    const unsigned quadrantSize = n*n/4;
+    for (unsigned k = 0; k < lattice.size(); ++k) {
+        const auto& pos = lattice[latticeOrder[k]];
+        const unsigned quadrant = 2*(pos[0] >= n/2) + (pos[1] >= n/2);
+        check(quadrant == k/quadrantSize, "Morton order does not keep the quadrants together");
+    }
+
+    checkPermutation(Opm::mortonOrder(std::vector<Position>()), 0);
+}
+
+template <class GridView>
+void testReorderedMapper(const GridView& gridView,
+                         const Dune::MCMGLayout& layout,
+                         const std::string& ordering)
+{
+    using Mapper = Opm::ReorderedMapper<TypeTag>;
+    using BaseMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+
+    Opm::GetProp<TypeTag, Opm::Properties::ParameterMetaData>::tree()["DofOrdering"] = ordering;
+
+    const Mapper mapper(gridView, layout);
+    const BaseMapper baseMapper(gridView, layout);
+    check(mapper.size() == baseMapper.size(), "the mapper has the wrong size");
+
+    // the new indices are a permutation of the natural ones and naturalIndex() is the
+    // inverse of the renumbering
+    std::vector<unsigned> buffer(mapper.size(), 0);
+    std::vector<bool> seen(mapper.size(), false);
+    const int codim = layout(Dune::GeometryTypes::vertex, GridView::dimension) ? GridView::dimension : 0;
+    for (const auto& elem : elements(gridView)) {
+        const unsigned numSubEntities = elem.subEntities(codim);
+        for (unsigned i = 0; i < numSubEntities; ++i) {
+            const unsigned newIdx = mapper.subIndex(elem, i, codim);
+            const unsigned natIdx = baseMapper.subIndex(elem, i, codim);
+            check(mapper.naturalIndex(newIdx) == natIdx, "naturalIndex() is not the inverse");
+            check(Opm::naturalIndex(mapper, newIdx) == natIdx, "Opm::naturalIndex() is not the inverse");
+            if (ordering == "natural")
+                check(newIdx == natIdx, "the natural ordering is not the identity");
+            seen[newIdx] = true;
+            buffer[newIdx] = natIdx;
+        }
+    }
+    check(std::all_of(seen.begin(), seen.end(), [](bool b) { return b; }),
+          "not all indices are used");
+
+    // a buffer in the new order becomes a buffer in the natural order
+    Opm::restoreNaturalOrder(mapper, buffer);
+    for (unsigned i = 0; i < buffer.size(); ++i)
+        check(buffer[i] == i, "restoreNaturalOrder() does not restore the natural order");
+
+    // all other mappers leave the buffer alone
+    Opm::restoreNaturalOrder(baseMapper, buffer);
+    for (unsigned i = 0; i < buffer.size(); ++i)
+        check(buffer[i] == i, "restoreNaturalOrder() modified the buffer of a regular mapper");
+}
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    return Opm::Test::run("test_dofordering", [&]() {
+        testReverseCuthillMcKee();
+        testMorton();
+
+        using namespace Opm;
+        Parameters::reset<TypeTag>();
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, DofOrdering,
+                             "The ordering of the degrees of freedom");
+        Parameters::endParamRegistration<TypeTag>();
+
+        using Grid = Dune::YaspGrid<2>;
+        const Grid grid(Dune::FieldVector<double, 2>(1.0), std::array<int, 2>{{7, 5}});
+        const auto gridView = grid.leafGridView();
+        for (const std::string ordering : {"natural", "rcm", "morton"}) {
+            testReorderedMapper(gridView, Dune::mcmgElementLayout(), ordering);
+            testReorderedMapper(gridView, Dune::mcmgVertexLayout(), ordering);
+        }
+    });
+}
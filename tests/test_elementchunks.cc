@@ -0,0 +1,159 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests that ElementChunks visits the same elements as ThreadedEntityIterator,
+ *        i.e., each element of the grid view exactly once.
+ */
+#include "config.h"
+
+#include <opm/models/parallel/elementchunks.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "unittestutils.hh"
+
+using Grid = Dune::YaspGrid<2>;
+using GridView = Grid::LeafGridView;
+using Chunks = Opm::ElementChunks<GridView>;
+
+using Opm::Test::check;
+
+// the number of times each element is visited by a parallel loop over the chunks
+std::vector<unsigned> visitChunks(const GridView& gridView, const Chunks& chunks)
+{
+    const std::size_t numElements = gridView.size(/*codim=*/0);
+    std::unique_ptr<std::atomic<unsigned>[]> numVisits(new std::atomic<unsigned>[numElements]);
+    for (std::size_t i = 0; i < numElements; ++i)
+        numVisits[i] = 0;
+
+    Chunks::Cursor cursor;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        chunks.forEach(cursor, [&](const auto& elem) {
+            ++numVisits[gridView.indexSet().index(elem)];
+        });
+    }
+
+    return std::vector<unsigned>(numVisits.get(), numVisits.get() + numElements);
+}
+
+// the same for the ThreadedEntityIterator which was used before
+std::vector<unsigned> visitThreadedIterator(const GridView& gridView)
+{
+    const std::size_t numElements = gridView.size(/*codim=*/0);
+    std::unique_ptr<std::atomic<unsigned>[]> numVisits(new std::atomic<unsigned>[numElements]);
+    for (std::size_t i = 0; i < numElements; ++i)
+        numVisits[i] = 0;
+
+    Opm::ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        auto elemIt = threadedElemIt.beginParallel();
+        for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment())
+            ++numVisits[gridView.indexSet().index(*elemIt)];
+    }
+
+    return std::vector<unsigned>(numVisits.get(), numVisits.get() + numElements);
+}
+
+void checkChunks(const GridView& gridView, const Chunks& chunks)
+{
+    check(chunks.size() == static_cast<std::size_t>(gridView.size(/*codim=*/0)),
+          "wrong number of elements");
+
+    const auto numVisits = visitChunks(gridView, chunks);
+    for (std::size_t i = 0; i < numVisits.size(); ++i)
+        check(numVisits[i] == 1, "element " + std::to_string(i) + " was visited "
+              + std::to_string(numVisits[i]) + " times");
+    check(numVisits == visitThreadedIterator(gridView),
+          "the chunks visit other elements than the threaded iterator");
+
+    // a sequential loop visits the elements in the order of the grid traversal
+    std::vector<int> order;
+    Chunks::Cursor cursor;
+    chunks.forEach(cursor, [&](const auto& elem) {
+        order.push_back(gridView.indexSet().index(elem));
+    });
+    std::vector<int> expectedOrder;
+    for (const auto& elem : elements(gridView))
+        expectedOrder.push_back(gridView.indexSet().index(elem));
+    check(order == expectedOrder, "the elements are not visited in the order of the grid");
+
+    // a finished cursor does not hand out any chunks
+    Chunks::Cursor finishedCursor;
+    finishedCursor.setFinished();
+    bool visited = false;
+    chunks.forEach(finishedCursor, [&](const auto&) { visited = true; });
+    check(!visited, "a finished cursor handed out elements");
+}
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    return Opm::Test::run("test_elementchunks", [&]() {
+        // grids with fewer elements than threads, with chunks of a single element and
+        // with chunks of the maximum size
+        for (int n : {1, 3, 40, 300}) {
+            Grid grid(Dune::FieldVector<double, 2>(1.0), std::array<int, 2>{{n, n}});
+            const GridView gridView = grid.leafGridView();
+            Chunks chunks(gridView);
+            checkChunks(gridView, chunks);
+
+#ifdef _OPENMP
+            // the chunks depend on the number of threads
+            const int maxThreads = omp_get_max_threads();
+            for (int numThreads : {1, 3, 2*maxThreads + 1}) {
+                omp_set_num_threads(numThreads);
+                chunks.update();
+                checkChunks(gridView, chunks);
+            }
+            omp_set_num_threads(maxThreads);
+#endif
+
+            // the elements must be collected again after the grid was modified
+            grid.globalRefine(1);
+            chunks.update();
+            checkChunks(gridView, chunks);
+        }
+    });
+}
@@ -0,0 +1,177 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests how the NlddSolver splits the cells into sub-domains and colors them.
+ */
+#include "config.h"
+
+#include <opm/models/nonlinear/nlddsolver.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+
+#include <string>
+#include <vector>
+
+#include "unittestutils.hh"
+
+using Matrix = Dune::BCRSMatrix<double>;
+using Graph = std::vector<std::vector<unsigned>>;
+
+static constexpr unsigned noDomain = static_cast<unsigned>(-1);
+
+using Opm::Test::check;
+
+// the sparsity pattern of a five-point stencil on a structured nx x ny grid
+Matrix fivePointMatrix(unsigned nx, unsigned ny)
+{
+    const unsigned n = nx*ny;
+    Matrix matrix(n, n, Matrix::random);
+    const auto neighbors = [&](unsigned i, unsigned j) {
+        std::vector<unsigned> result;
+        if (j > 0)
+            result.push_back((j - 1)*nx + i);
+        if (i > 0)
+            result.push_back(j*nx + i - 1);
+        result.push_back(j*nx + i);
+        if (i + 1 < nx)
+            result.push_back(j*nx + i + 1);
+        if (j + 1 < ny)
+            result.push_back((j + 1)*nx + i);
+        return result;
+    };
+    for (unsigned j = 0; j < ny; ++j)
+        for (unsigned i = 0; i < nx; ++i)
+            matrix.setrowsize(j*nx + i, neighbors(i, j).size());
+    matrix.endrowsizes();
+    for (unsigned j = 0; j < ny; ++j)
+        for (unsigned i = 0; i < nx; ++i)
+            for (unsigned colIdx : neighbors(i, j))
+                matrix.addindex(j*nx + i, colIdx);
+    matrix.endindices();
+    matrix = 0.0;
+    return matrix;
+}
+
+void testSplit(const std::vector<int>& cells, std::size_t numDomains)
+{
+    const auto domainCells = Opm::detail::splitCells(cells, numDomains);
+    check(domainCells.size() == numDomains, "wrong number of domains");
+
+    // the domains are consecutive pieces of the list of cells whose sizes differ by at
+    // most one
+    std::vector<int> concatenated;
+    std::size_t minSize = cells.size();
+    std::size_t maxSize = 0;
+    for (const auto& domain : domainCells) {
+        concatenated.insert(concatenated.end(), domain.begin(), domain.end());
+        minSize = std::min(minSize, domain.size());
+        maxSize = std::max(maxSize, domain.size());
+    }
+    check(concatenated == cells, "the domains are not a partition of the cells");
+    check(maxSize - minSize <= 1, "the domains are not balanced");
+}
+
+void testColoring(unsigned nx, unsigned ny, unsigned numInteriorRows, std::size_t numDomains)
+{
+    const Matrix matrix = fivePointMatrix(nx, ny);
+
+    // the cells of the last rows of the grid do not belong to any domain, like the
+    // overlap cells of a parallel run
+    std::vector<int> interiorCells;
+    for (unsigned cellIdx = 0; cellIdx < nx*numInteriorRows; ++cellIdx)
+        interiorCells.push_back(static_cast<int>(cellIdx));
+
+    const auto domainCells = Opm::detail::splitCells(interiorCells, numDomains);
+    std::vector<unsigned> cellDomain(nx*ny, noDomain);
+    for (unsigned domainIdx = 0; domainIdx < numDomains; ++domainIdx)
+        for (int cellIdx : domainCells[domainIdx])
+            cellDomain[cellIdx] = domainIdx;
+
+    const Graph neighbors = Opm::detail::domainNeighbors(matrix, domainCells, cellDomain, noDomain);
+    check(neighbors.size() == numDomains, "wrong number of adjacency lists");
+
+    // compare the coupling of the domains with the one derived from the grid directly
+    std::vector<std::vector<char>> coupled(numDomains, std::vector<char>(numDomains, 0));
+    for (unsigned j = 0; j < numInteriorRows; ++j) {
+        for (unsigned i = 0; i < nx; ++i) {
+            const unsigned cellIdx = j*nx + i;
+            if (i + 1 < nx && cellDomain[cellIdx] != cellDomain[cellIdx + 1])
+                coupled[cellDomain[cellIdx]][cellDomain[cellIdx + 1]] =
+                    coupled[cellDomain[cellIdx + 1]][cellDomain[cellIdx]] = 1;
+            if (j + 1 < numInteriorRows && cellDomain[cellIdx] != cellDomain[cellIdx + nx])
+                coupled[cellDomain[cellIdx]][cellDomain[cellIdx + nx]] =
+                    coupled[cellDomain[cellIdx + nx]][cellDomain[cellIdx]] = 1;
+        }
+    }
+    for (unsigned domainIdx = 0; domainIdx < numDomains; ++domainIdx) {
+        std::vector<unsigned> expected;
+        for (unsigned otherIdx = 0; otherIdx < numDomains; ++otherIdx)
+            if (coupled[domainIdx][otherIdx])
+                expected.push_back(otherIdx);
+        check(neighbors[domainIdx] == expected,
+              "wrong neighbors of domain " + std::to_string(domainIdx));
+    }
+
+    // coupled domains must have different colors and the colors must be contiguous
+    const auto color = Opm::detail::greedyColoring(neighbors);
+    check(color.size() == numDomains, "wrong number of colors");
+    unsigned numColors = 0;
+    for (unsigned domainIdx = 0; domainIdx < numDomains; ++domainIdx) {
+        numColors = std::max(numColors, color[domainIdx] + 1);
+        for (unsigned neighborIdx : neighbors[domainIdx])
+            check(color[domainIdx] != color[neighborIdx],
+                  "coupled domains " + std::to_string(domainIdx) + " and "
+                  + std::to_string(neighborIdx) + " have the same color");
+    }
+    std::vector<char> colorUsed(numColors, 0);
+    for (unsigned c : color)
+        colorUsed[c] = 1;
+    for (char used : colorUsed)
+        check(used, "the colors are not contiguous");
+
+    // if each domain consists of complete rows of the grid, the domains form a chain
+    // which only needs two colors
+    if (numInteriorRows % numDomains == 0 && numDomains > 1)
+        check(numColors == 2, "a chain of domains needs exactly two colors");
+}
+
+int main()
+{
+    return Opm::Test::run("test_nlddsolver", [&]() {
+        std::vector<int> cells;
+        for (int i = 0; i < 101; ++i)
+            cells.push_back(3*i);
+        for (std::size_t numDomains : {1, 2, 7, 100, 101})
+            testSplit(cells, numDomains);
+        testSplit(std::vector<int>(), 1);
+
+        testColoring(/*nx=*/12, /*ny=*/10, /*numInteriorRows=*/10, /*numDomains=*/5);
+        testColoring(12, 10, 8, 4);
+        testColoring(12, 10, 10, 7);
+        testColoring(12, 10, 10, 33);
+        testColoring(12, 10, 10, 1);
+        check(Opm::detail::greedyColoring(Graph()).empty(), "an empty graph has no colors");
+    });
+}
@@ -0,0 +1,176 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests the factors by which the PID time step controller changes the time step
+ *        size for synthetic sequences of errors and failures of the Newton method.
+ */
+#include "config.h"
+
+#include <opm/models/discretization/common/pidtimestepcontroller.hh>
+
+#include <cmath>
+#include <string>
+
+#include "unittestutils.hh"
+
+using Control = Opm::detail::PidStepSizeControl<double>;
+
+static constexpr double maxGrowth = 3.0;
+static constexpr double restartFactor = 0.5;
+static constexpr unsigned growthDelay = 2;
+
+using Opm::Test::check;
+
+void checkClose(double value, double expected, const std::string& msg)
+{
+    check(std::abs(value - expected) <= 1e-12*std::abs(expected),
+          msg + ": " + std::to_string(value) + " instead of " + std::to_string(expected));
+}
+
+// the factor of the PID controller for the errors e0, e1 and e2 of the last three
+// time steps, the most recent one last
+double pidFactor(double e0, double e1, double e2)
+{
+    return std::pow(e1/e2, 0.075)*std::pow(1.0/e2, 0.175)*std::pow(e1*e1/(e2*e0), 0.01);
+}
+
+void testPidFactor()
+{
+    Control control(maxGrowth, restartFactor, growthDelay);
+    checkClose(control.growthFactor(), 1.0, "the time step size changed without any error");
+
+    // with fewer than three errors, the missing ones are assumed to be equal to the
+    // oldest known one
+    control.timeStepSucceeded(0.8);
+    checkClose(control.growthFactor(), pidFactor(0.8, 0.8, 0.8), "wrong factor after one step");
+    control.timeStepSucceeded(0.4);
+    checkClose(control.growthFactor(), pidFactor(0.8, 0.8, 0.4), "wrong factor after two steps");
+    control.timeStepSucceeded(0.2);
+    checkClose(control.growthFactor(), pidFactor(0.8, 0.4, 0.2), "wrong factor after three steps");
+    control.timeStepSucceeded(0.5);
+    checkClose(control.growthFactor(), pidFactor(0.4, 0.2, 0.5), "wrong factor after four steps");
+
+    // the error of the target is kept
+    control.timeStepSucceeded(1.0);
+    control.timeStepSucceeded(1.0);
+    control.timeStepSucceeded(1.0);
+    checkClose(control.growthFactor(), 1.0, "the time step size changed at the target error");
+
+    // errors above the target reduce the time step size proportionally, but not by
+    // more than the minimum factor
+    control.timeStepSucceeded(2.0);
+    checkClose(control.growthFactor(), 0.5, "wrong factor for an error above the target");
+    control.timeStepSucceeded(10.0);
+    checkClose(control.growthFactor(), Control::minFactor, "the factor was not limited from below");
+
+    // tiny errors do not increase the time step size beyond the maximum growth
+    control.timeStepSucceeded(0.0);
+    control.timeStepSucceeded(0.0);
+    control.timeStepSucceeded(0.0);
+    checkClose(control.growthFactor(), maxGrowth, "the factor was not limited from above");
+}
+
+void testGrowthDelay()
+{
+    Control control(maxGrowth, restartFactor, growthDelay);
+    for (unsigned i = 0; i < 3; ++i)
+        control.timeStepSucceeded(0.1);
+    check(control.growthFactor() > 1.0, "small errors did not increase the time step size");
+
+    control.timeStepFailed(/*numFailures=*/0);
+    for (unsigned stepIdx = 1; stepIdx <= growthDelay; ++stepIdx) {
+        control.timeStepSucceeded(0.1);
+        checkClose(control.growthFactor(), 1.0,
+                   "the time step size increased " + std::to_string(stepIdx)
+                   + " steps after a failure");
+    }
+
+    // reductions are not delayed
+    control.timeStepFailed(0);
+    control.timeStepSucceeded(2.0);
+    checkClose(control.growthFactor(), 0.5, "a reduction was delayed after a failure");
+    for (unsigned i = 0; i < 3; ++i)
+        control.timeStepSucceeded(0.1);
+    checkClose(control.growthFactor(), pidFactor(0.1, 0.1, 0.1),
+               "the time step size did not increase after the delay");
+}
+
+void testRestart()
+{
+    Control control(maxGrowth, restartFactor, growthDelay);
+
+    // each failure of a time step reduces the size of the failed attempt once
+    checkClose(control.timeStepFailed(/*numFailures=*/0), restartFactor, "wrong first reduction");
+    checkClose(control.timeStepFailed(1), restartFactor, "wrong second reduction");
+    checkClose(control.timeStepFailed(2), restartFactor, "wrong third reduction");
+
+    // a time step which fails shortly after the previous failure is reduced once more
+    for (unsigned stepIdx = 1; stepIdx <= growthDelay; ++stepIdx) {
+        for (unsigned i = 0; i < stepIdx; ++i)
+            control.timeStepSucceeded(1.0);
+        checkClose(control.timeStepFailed(0), std::pow(restartFactor, 2),
+                   "a failure " + std::to_string(stepIdx)
+                   + " steps after the previous one was not reduced further");
+        checkClose(control.timeStepFailed(1), restartFactor,
+                   "a repeated failure was reduced too strongly");
+    }
+
+    // afterwards, the previous failure is forgotten
+    for (unsigned stepIdx = 0; stepIdx <= growthDelay; ++stepIdx)
+        control.timeStepSucceeded(1.0);
+    checkClose(control.timeStepFailed(0), restartFactor,
+               "a failure long after the previous one was reduced further");
+}
+
+// the size of the attempts of a time step which fails repeatedly, like
+// FvBaseProblem::timeIntegration() determines them
+void testRepeatedRestart(bool recentFailure)
+{
+    Control control(maxGrowth, restartFactor, growthDelay);
+    if (recentFailure) {
+        control.timeStepFailed(0);
+        control.timeStepSucceeded(1.0);
+    }
+
+    const unsigned numAttempts = 10;
+    double dt = 1.0;
+    for (unsigned numFailures = 0; numFailures < numAttempts; ++numFailures)
+        dt *= control.timeStepFailed(numFailures);
+
+    const unsigned numReductions = recentFailure ? numAttempts + 1 : numAttempts;
+    checkClose(dt, std::pow(restartFactor, numReductions),
+               "wrong size after " + std::to_string(numAttempts) + " failed attempts");
+}
+
+int main()
+{
+    return Opm::Test::run("test_pidtimestepcontroller", [&]() {
+        testPidFactor();
+        testGrowthDelay();
+        testRestart();
+        testRepeatedRestart(/*recentFailure=*/false);
+        testRepeatedRestart(/*recentFailure=*/true);
+    });
+}
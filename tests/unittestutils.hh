@@ -0,0 +1,72 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Helpers shared by the unit tests which do not run a simulation.
+ */
+#ifndef EWOMS_UNIT_TEST_UTILS_HH
+#define EWOMS_UNIT_TEST_UTILS_HH
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace Opm::Test {
+
+/*!
+ * \brief Throws an exception with the given message if the condition does not hold.
+ *
+ * This must not be called inside of parallel regions because the exception cannot
+ * leave them.
+ */
+inline void check(bool condition, const std::string& msg)
+{
+    if (!condition)
+        throw std::logic_error(msg);
+}
+
+/*!
+ * \brief Runs the checks of a unit test and returns the exit code of the test.
+ *
+ * If a check fails, its message is printed and EXIT_FAILURE is returned.
+ */
+template <class Fn>
+int run(const std::string& testName, Fn&& fn)
+{
+    try {
+        fn();
+    }
+    catch (const std::exception& e) {
+        std::cerr << testName << " failed: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+} // namespace Opm::Test
+
+#endif